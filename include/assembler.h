@@ -9,16 +9,264 @@
 #include <iostream>
 #include <iomanip>
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+// ==================== Profiler ====================
+// 단계별 실행 시간과 힙 할당 통계 (--profile)
+// 할당 통계는 -DASM_TRACK_ALLOC로 빌드해야 전역 new/delete를 가로채서 수집됨
+struct PhaseStats {
+    std::string name;
+    double millis = 0;
+    unsigned long long allocCount = 0;
+    unsigned long long allocBytes = 0;
+    unsigned long long peakLiveBytes = 0;
+};
+
+class Profiler {
+private:
+    std::vector<PhaseStats> phases;
+    int current;  // 진행 중인 단계 (-1이면 없음)
+    std::chrono::steady_clock::time_point phaseStart;
+    unsigned long long countAtStart;
+    unsigned long long bytesAtStart;
+
+public:
+    Profiler();
+    static bool allocTrackingEnabled();
+    // 같은 이름으로 다시 시작하면 기존 단계에 누적 (진행 중인 단계는 자동 종료)
+    void begin(const std::string& phase);
+    void end();
+    void report() const;
+};
+
+// ==================== Trace ====================
+// -DASM_TRACE로 빌드하면 중첩 구간(span)을 스레드별 버퍼에 기록해 Chrome trace JSON으로 출력
+// (chrome://tracing, Perfetto에서 열기), 끄면 TRACE_SPAN은 아무 코드도 만들지 않음
+#ifdef ASM_TRACE
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 스레드별 버퍼에 잠금 없이 추가 (name은 문자열 리터럴이나 intern()의 결과)
+    static void record(const char* name, Clock::time_point begin, Clock::time_point end);
+    // 동적 이름을 프로그램 종료까지 유지되는 문자열로 변환
+    static const char* intern(const std::string& name);
+    // 다른 스레드가 모두 끝난 뒤 호출
+    static bool writeJson(const std::string& filename);
+};
+
+class TraceSpan {
+private:
+    const char* name;
+    Trace::Clock::time_point begin;
+
+public:
+    explicit TraceSpan(const char* spanName) : name(spanName), begin(Trace::Clock::now()) {}
+    ~TraceSpan() { Trace::record(name, begin, Trace::Clock::now()); }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#else
+#define TRACE_SPAN(name) ((void)0)
+#endif
+
+// ==================== Diagnostics ====================
+// 소스 오류/경고 수집기: 스레드별 버퍼에 모아 두었다가 flush에서 라인 순으로 한 번에 출력
+// 코드 표
+//   E100 알 수 없는 opcode          E101 잘못된 START 주소       E102 잘못된 EQU 피연산자
+//   E103 Format 4 불가 명령어        E104 잘못된 SVC 번호         E105 알 수 없는 레지스터
+//   E106 잘못된 SHIFT 횟수          E107 RESW/RESB의 미정의 심볼  E108 라벨 없는 EQU
+//   E109 중복 심볼                  E110 잘못된 IF 조건          E111 IF 조건의 미정의 심볼
+//   E112 IF 조건의 재배치 심볼       E113 짝 없는/중복 ELSE        E114 짝 없는 ENDIF
+//   E115 ENDIF 없는 IF               E116 잘못된 FILL 피연산자/크기
+//   E200 알 수 없는 명령어 형식      E201 미정의 피연산자 심볼     E202 WORD의 미정의 심볼
+//   E203 END의 미정의 심볼           E204 변위/주소 필드 범위 초과
+//   E205 12비트 필드의 재배치 심볼
+enum class Severity { NOTE, WARNING, ERROR };
+
+struct Diagnostic {
+    Severity severity;
+    const char* code;     // 위 코드 표의 문자열 리터럴
+    int line;             // 소스 라인 (0이면 없음)
+    int address;          // 관련 주소 (-1이면 없음)
+    std::string message;
+};
+
+class Diagnostics {
+public:
+    static void setSourceFile(const std::string& filename);
+    // 오류가 limit개 쌓이면 shouldAbort()가 true (0이면 제한 없음)
+    static void setMaxErrors(int limit);
+    static void report(Severity severity, const char* code, int line, int address,
+                       const std::string& message);
+    static void error(const char* code, int line, const std::string& message, int address = -1);
+    static void warning(const char* code, int line, const std::string& message, int address = -1);
+    static bool shouldAbort();
+    static int errorCount();
+    static int warningCount();
+    // 모인 진단을 (라인, 보고 순서)로 정렬해 출력 (다른 스레드가 보고를 멈춘 뒤 호출)
+    static void flush(std::ostream& out);
+    // 지금까지 flush된 진단 전체를 JSON으로 저장
+    static bool writeJson(const std::string& filename);
+    static void reset();
+};
+
+// ==================== SpscRing ====================
+// 단일 생산자/단일 소비자 고정 크기 링 버퍼 (lock-free)
+// 가득 차거나 비었을 때는 yield하며 대기, cancel이 켜지면 포기
+template <typename T>
+class SpscRing {
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;  // 소비자가 다음에 읽을 위치
+    alignas(64) std::atomic<size_t> tail;  // 생산자가 다음에 쓸 위치
+
+public:
+    explicit SpscRing(size_t capacity) : head(0), tail(0) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;  // 2의 거듭제곱으로 맞춤
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    bool tryPush(T& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;  // 가득 참
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;  // 비어 있음
+        item = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(T& item, const std::atomic<bool>& cancel) {
+        while (!tryPush(item)) {
+            if (cancel.load(std::memory_order_relaxed)) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    bool pop(T& item, const std::atomic<bool>& cancel) {
+        while (!tryPop(item)) {
+            if (cancel.load(std::memory_order_relaxed)) return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+};
+
+// ==================== AsyncWriter ====================
+// 파일 출력 작업을 백그라운드 스레드에서 순서대로 실행 (계산과 I/O 겹치기)
+// 작업이 몇 개뿐이므로 큐가 비면 조건 변수로 잠듦 (Pass 1 링처럼 돌며 기다리지 않음)
+class AsyncWriter {
+private:
+    SpscRing<std::function<void()>> tasks;
+    std::atomic<bool> closed;
+    std::atomic<bool> cancel;
+    std::mutex mutex;
+    std::condition_variable wake;  // submit/finish가 깨움
+    std::thread worker;
+
+    void run();
+
+public:
+    AsyncWriter();
+    ~AsyncWriter();
+    void submit(std::function<void()> task);
+    void finish();  // 남은 작업을 모두 끝내고 스레드 종료
+};
+
+// ==================== FileWatcher ====================
+// inotify로 파일 변경 감시 (--watch)
+// 편집기는 임시 파일을 rename해서 저장하기도 하므로 파일이 아니라 들어 있는 디렉터리를 감시
+class FileWatcher {
+private:
+    int fd;
+    std::map<int, std::string> directories;  // watch descriptor -> 디렉터리
+    std::vector<std::string> files;          // 감시 대상 경로
+
+public:
+    FileWatcher();
+    ~FileWatcher();
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    bool add(const std::string& path);
+    // 변경이 생길 때까지 기다린 뒤, 마지막 이벤트 후 quietMillis 동안 조용해지면
+    // 그동안 바뀐 파일 경로를 반환 (연속 저장을 한 번으로 묶음)
+    std::vector<std::string> wait(int quietMillis);
+};
+
+// ==================== AssemblyCache ====================
+// 실행 사이에 유지되는 내용 주소 캐시 (--cache <dir>)
+// 키 = 소스, OPTAB, 심볼 스냅샷, 출력에 영향을 주는 옵션의 128비트 FNV-1a 해시
+// 항목 하나가 파일 하나(<key>.entry): 출력 파일들과 리스팅 텍스트를 이어 붙인 묶음
+class ContentHash {
+private:
+    uint64_t high, low;  // 128비트 FNV 상태 (상위/하위 64비트)
+
+public:
+    ContentHash();
+    void update(const void* data, size_t size);
+    void updateString(const std::string& str);     // 길이도 섞음 (필드 경계가 모호하지 않도록)
+    bool updateFile(const std::string& filename);  // 파일 이름과 내용
+    std::string hex() const;
+};
+
+class AssemblyCache {
+private:
+    std::string directory;
+    uint64_t maxBytes;
+    int hits, misses, stores, evictions;  // 이번 실행
+    int recorded[4];                      // STATS 파일에 이미 반영한 값
+
+    std::string entryPath(const std::string& key) const;
+    void evict(const std::string& keep);
+
+public:
+    AssemblyCache(const std::string& dir, uint64_t limitBytes);
+    bool open();
+    // 적중하면 저장된 출력 파일을 원래 경로(pathFor로 바꾼 경로)에 복원하고 리스팅을 돌려줌
+    bool lookup(const std::string& key, std::string& listing,
+                const std::function<std::string(const std::string&)>& pathFor);
+    // 쓰기는 임시 파일 + rename으로 원자적, 넣은 뒤 크기 제한을 넘으면 오래 안 쓴 항목부터 삭제
+    bool store(const std::string& key, const std::vector<std::string>& files,
+               const std::string& listing);
+    void finish();             // 누적 통계 파일(STATS)에 반영
+    void printStats() const;   // 이번 실행 + 누적 통계와 현재 크기
+};
 
 // ==================== OPTAB ====================
 struct InstructionInfo {
+    std::string mnemonic;
     std::string opcode;
+    int opcodeValue;  // opcode의 정수 값 (Pass2 인코딩용)
     int format;  // 1, 2, 3/4
 };
 
 class OPTAB {
 private:
-    std::map<std::string, InstructionInfo> table;
+    std::vector<InstructionInfo> entries;     // ID로 색인
+    std::map<std::string, int> table;        // 니모닉 -> ID
     
     // 자동으로 형식 결정
     int determineFormat(const std::string& mnemonic);
@@ -29,21 +277,97 @@ public:
     bool isInstruction(const std::string& mnemonic) const;
     std::string getOpcode(const std::string& mnemonic) const;
     int getFormat(const std::string& mnemonic) const;
+    int getId(const std::string& mnemonic) const;  // 없으면 -1
+    const InstructionInfo& getInfo(int id) const;
+    int size() const;
+    uint64_t digest() const;  // 중간파일이 같은 opcode ID로 쓰였는지 확인
     void printTable() const;
 };
 
 // ==================== SYMTAB ====================
+struct SymbolEntry {
+    std::string name;
+    int address;
+    bool defined;    // 전방 참조로만 등록된 심볼은 false
+    bool relative;   // 재배치 대상 주소 (EQU 상수는 false)
+    int block;       // 프로그램 블록 번호 (address는 블록 기준 상대 주소)
+    bool fromLayer;  // 스냅샷(계층 또는 미리 채우기)에서 가져온 외부 심볼 (로컬 정의가 덮어씀)
+};
+
+// 바이너리 심볼 스냅샷 (mmap으로 열어 파싱 없이 조회)
+// [헤더][주소순 엔트리 배열][해시 색인][문자열 블록(NUL 종료)]
+class SymbolSnapshot {
+public:
+    struct Header {
+        char magic[4];         // "SYMB"
+        uint32_t version;
+        uint32_t count;        // 엔트리 수
+        uint32_t hashSize;     // 해시 색인 칸 수 (2의 거듭제곱)
+        uint32_t stringBytes;  // 문자열 블록 크기
+        uint32_t reserved;
+    };
+    struct Entry {
+        uint32_t address;
+        uint32_t nameOffset;   // 문자열 블록 안의 위치
+        uint32_t nameLength;
+        uint32_t flags;        // bit 0: 재배치 대상
+    };
+    static const uint32_t VERSION = 1;
+    static const uint32_t FLAG_RELATIVE = 1;
+
+private:
+    const unsigned char* base;
+    size_t mappedSize;
+    const Header* header;
+    const Entry* entries;
+    const uint32_t* hashIndex;  // 엔트리 번호 + 1 (0이면 빈 칸)
+    const char* strings;
+
+public:
+    SymbolSnapshot();
+    ~SymbolSnapshot();
+    SymbolSnapshot(const SymbolSnapshot&) = delete;
+    SymbolSnapshot& operator=(const SymbolSnapshot&) = delete;
+
+    static uint32_t hashName(const char* name, size_t length);
+    static bool isSnapshotFile(const std::string& filename);
+    bool open(const std::string& filename);
+    int size() const;
+    const Entry& entry(int index) const;
+    std::string nameOf(const Entry& e) const;
+    int find(const std::string& name) const;          // 엔트리 번호, 없으면 -1
+    int findByAddress(int address) const;             // 해당 주소의 첫 엔트리, 없으면 -1
+};
+
 class SYMTAB {
 private:
-    std::map<std::string, int> table;
+    std::vector<SymbolEntry> symbols;     // ID로 색인
+    std::map<std::string, int> table;    // 심볼 -> ID
+    std::shared_ptr<SymbolSnapshot> layer;  // 읽기 전용 심볼 계층 (없으면 nullptr)
 
 public:
     SYMTAB();
-    bool insert(const std::string& symbol, int address);
+    bool insert(const std::string& symbol, int address, bool relative = true, int block = 0);
+    int intern(const std::string& symbol);  // 참조용 ID (미정의 허용)
     int lookup(const std::string& symbol) const;
     bool exists(const std::string& symbol) const;
+    bool isDefined(int id) const;
+    int addressOf(int id) const;  // 미정의면 -1
+    bool isRelative(int id) const;
+    int blockOf(int id) const;  // 블록 기준 주소의 블록 번호 (절대/외부 심볼은 -1)
+    const std::string& nameOf(int id) const;
+    int size() const;  // 심볼 ID 개수
+    // 이미 정의된 재배치 심볼의 주소를 블록 기준으로 다시 지정 (최적화 후 재배치용)
+    bool redefine(int id, int address, int block);
+    // 라벨이 붙은 라인을 지운 뒤 그 라벨을 미정의로 되돌림 (--strip)
+    void undefine(int id);
+    // Pass1 종료 후 블록 기준 주소를 최종 주소로 변환
+    void relocateBlocks(const std::vector<int>& blockStarts);
     void print() const;
     void writeToFile(const std::string& filename) const;
+    bool writeSnapshot(const std::string& filename) const;
+    // readOnlyLayer면 mmap한 채로 조회 시에만 참조, 아니면 모든 심볼을 미리 삽입
+    bool loadSnapshot(const std::string& filename, bool readOnlyLayer);
 };
 
 // ==================== Parser ====================
@@ -51,13 +375,114 @@ struct SourceLine {
     std::string label;
     std::string opcode;
     std::string operand;
+    // operand 안의 구분자 위치 (find/rfind 결과와 같음, 없으면 npos)
+    size_t comma = std::string::npos;      // 첫 ','
+    size_t quote = std::string::npos;      // 첫 '\''
+    size_t lastQuote = std::string::npos;  // 마지막 '\''
 };
 
+enum class Directive { NONE, START, END, WORD, BYTE, RESW, RESB, EQU, USE, IF, ELSE, ENDIF, FILL };
+
 class Parser {
 public:
     static SourceLine parseLine(const std::string& line);
     static std::string trim(const std::string& str);
     static bool startsWithWhitespace(const std::string& line);
+    // 예외 없는 숫자 파싱 (문자열 전체가 숫자여야 성공)
+    static bool parseNumber(const std::string& str, int& value, int base = 10);
+    static int registerNumber(const std::string& reg);  // 없으면 -1
+    static Directive directiveOf(const std::string& opcode);
+    // FILL 피연산자 "반복 수,값" 분리 (값: 0..255 숫자, X'..', C'..' -> 패턴 바이트)
+    static bool parseFillOperand(const std::string& operand, std::string& count, std::string& pattern);
+    static bool parseFillOperand(const std::string& operand, size_t comma, std::string& count,
+                                 std::string& pattern);
+};
+
+// ==================== Scanner ====================
+// 소스 버퍼를 16/32바이트씩 한 번만 분류해 개행·공백·따옴표·쉼표 비트마스크를 만들고
+// 라인별 필드 위치와 피연산자 구분자 위치를 비트 연산으로 구함
+// (AVX2 또는 SSE2로 빌드되면 벡터 비교, 아니면 스칼라)
+struct LineFields {
+    int lineNum;
+    size_t labelBegin, labelEnd;      // 라벨 없으면 begin == end
+    size_t opcodeBegin, opcodeEnd;
+    size_t operandBegin, operandEnd;  // 앞뒤 공백 제거된 나머지 전체
+    size_t firstComma;                // operand 안의 구분자 (없으면 operandEnd)
+    size_t firstQuote, lastQuote;
+};
+
+class Scanner {
+public:
+    // data[0..size)에서 완결된 라인들의 필드 위치를 out에 추가하고 소비한 바이트 수 반환
+    // final이면 개행 없이 끝나는 마지막 라인도 포함
+    // 주석(#)·빈 줄·공백만 있는 줄은 결과에 넣지 않음 (lineNum은 계속 증가)
+    static size_t scan(const char* data, size_t size, int& lineNum,
+                       std::vector<LineFields>& out, bool final);
+    static SourceLine toSourceLine(const char* data, const LineFields& fields);
+    static const char* simdLevel();
+};
+
+// ==================== Operand ====================
+enum class AddrMode { NONE, SIMPLE, IMMEDIATE, INDIRECT };
+
+// Pass1에서 한 번만 해석해 두는 피연산자 (Pass2는 정수 인코딩만 수행)
+struct ParsedOperand {
+    AddrMode mode = AddrMode::NONE;
+    bool indexed = false;    // ,X
+    bool extended = false;   // + (Format 4)
+    int opId = -1;           // OPTAB ID (지시어면 -1)
+    int r1 = 0, r2 = 0;      // Format 2 레지스터 (SHIFT는 r2 = n-1)
+    bool isNumber = false;
+    int value = 0;           // 숫자 피연산자 값
+    int symId = -1;          // 심볼 피연산자 ID
+};
+
+// ==================== LineMap ====================
+// 주소 -> 소스 라인 표 (DWARF 라인 프로그램처럼 행을 (주소 증가분, 라인 증가분) LEB128로 압축)
+// 행 하나는 "이 주소부터 다음 행 전까지 이 라인", 라인 0은 소스 없음 (RESW/RESB 등 빈 구간)
+// CHECKPOINT_INTERVAL 행마다 절대 위치를 둬서 이진 탐색 후 최대 그만큼만 풀어서 조회
+class LineMap {
+public:
+    struct Checkpoint {
+        uint32_t address;
+        uint32_t line;
+        uint32_t offset;  // 이 행 다음 행이 시작되는 encoded 위치
+    };
+    struct FileHeader {
+        char magic[4];    // "LMAP"
+        uint32_t version;
+        uint32_t rowCount;
+        uint32_t checkpointCount;
+        uint32_t encodedBytes;
+        uint32_t fileNameLength;
+    };
+    static const int CHECKPOINT_INTERVAL = 16;
+
+private:
+    std::string sourceFile;
+    std::vector<uint8_t> encoded;
+    std::vector<Checkpoint> checkpoints;
+    uint32_t rowCount;
+
+    // 빌드 중 상태
+    int lastAddress;  // 마지막 행의 주소와 라인
+    int lastLine;
+    int endAddress;   // 마지막 구간의 끝 (-1이면 아직 없음)
+
+    void appendRow(int address, int line);
+
+public:
+    LineMap();
+    void setSourceFile(const std::string& filename);
+    const std::string& getSourceFile() const;
+    // [address, address + length) 구간이 lineNum에서 왔음 (주소 오름차순으로 호출)
+    void add(int address, int length, int lineNum);
+    void finish();
+    int lookup(int address) const;  // 해당 주소의 소스 라인 (없으면 0)
+    size_t getRowCount() const;
+    size_t getEncodedSize() const;
+    bool writeToFile(const std::string& filename) const;
+    bool loadFromFile(const std::string& filename);
 };
 
 // ==================== Pass1 ====================
@@ -68,6 +493,140 @@ struct IntermediateLine {
     std::string operand;
     std::string objcode;
     bool hasLocation;
+    Directive directive = Directive::NONE;
+    ParsedOperand parsed;
+    int block = 0;   // 프로그램 블록 번호
+    int length = 0;  // 바이트 수 (PC = location + length)
+    int lineNum = 0; // 소스 라인 번호 (1부터)
+};
+
+// 프로그램 블록 (USE): 블록마다 독립된 LOCCTR
+struct ProgramBlock {
+    std::string name;
+    int locctr;  // 블록 기준 상대 주소
+    int start;   // Pass1 종료 후 배정되는 최종 시작 주소
+};
+
+// 조건부 어셈블리 (IF/ELSE/ENDIF) 중첩 한 단계
+// 조립 중인 구간 안의 IF만 평가해서 쌓으므로, 맨 위가 아닌 항목은 항상 active
+struct ConditionalFrame {
+    bool active;    // 지금 분기를 조립하는 중
+    bool taken;     // 이미 참인 분기가 있었음 (ELSE는 그렇지 않을 때만 활성)
+    bool seenElse;
+    int lineNum;    // IF의 라인 (ENDIF가 없을 때 보고)
+};
+
+// ==================== IntermediateFile ====================
+// 메모리에 다 올리지 않는 바이너리 중간파일 (--out-of-core)
+// INTFILE.bin: [헤더][고정 크기 레코드...][블록 시작 주소][심볼 이름 색인]
+// INTFILE.str: 라벨/opcode/operand와 심볼 이름을 이어 붙인 문자열 힙
+// (호스트 바이트 순서, 심볼 ID는 이름 색인으로 다른 프로세스의 SYMTAB에 다시 연결,
+//  opcode ID는 그대로 쓰므로 OPTAB 다이제스트가 같아야 읽음)
+struct IntermediateFileHeader {
+    char magic[4];         // "INTB"
+    uint32_t version;
+    uint64_t count;        // 레코드 수
+    int32_t startAddr;
+    int32_t programLength;
+    uint32_t blockCount;
+    uint32_t symbolCount;
+    char name[8];          // 프로그램 이름 (NUL 채움)
+    uint64_t optabDigest;  // OPTAB::digest()
+};
+
+struct IntermediateRecord {
+    int32_t location;      // 블록 기준 주소 (읽을 때 블록 시작 주소를 더함)
+    int32_t length;
+    int32_t block;
+    uint8_t directive;
+    uint8_t flags;         // FLAG_* 비트
+    uint8_t mode;          // AddrMode
+    uint8_t reserved;
+    int32_t opId;
+    int8_t r1, r2;
+    int16_t reserved2;
+    int32_t value;
+    int32_t symId;         // 쓴 프로세스의 SYMTAB ID
+    uint64_t textOffset;   // 문자열 힙에서 label, opcode, operand가 이어진 위치
+    uint16_t labelLength;
+    uint16_t opcodeLength;
+    uint32_t operandLength;
+    int32_t lineNum;
+    uint32_t reserved3;
+
+    static const uint8_t FLAG_HAS_LOCATION = 1;
+    static const uint8_t FLAG_INDEXED = 2;
+    static const uint8_t FLAG_EXTENDED = 4;
+    static const uint8_t FLAG_IS_NUMBER = 8;
+};
+
+struct IntermediateSymbolName {
+    uint64_t offset;       // 문자열 힙 위치
+    uint32_t length;
+    uint32_t reserved;
+};
+
+// Pass1 쪽: 레코드를 버퍼를 거쳐 순서대로 디스크에 씀 (메모리 사용량 고정)
+class IntermediateWriter {
+private:
+    std::ofstream records;
+    std::ofstream strings;
+    std::vector<char> recordBuffer;
+    std::vector<char> stringBuffer;
+    uint64_t count;
+    uint64_t stringBytes;
+
+public:
+    IntermediateWriter();
+    bool open(const std::string& recordFilename, const std::string& stringFilename);
+    void append(const IntermediateLine& line);
+    // 블록 시작 주소, 심볼 이름 색인을 덧붙이고 헤더를 채움
+    bool finish(int startAddr, int programLength, const std::string& programName,
+                const std::vector<int>& blockStarts, const SYMTAB& symtab, uint64_t optabDigest);
+    uint64_t size() const;
+};
+
+// Pass2 쪽: 두 파일을 mmap해서 순차적으로 읽음
+// 열 때 모든 레코드를 한 번 검사하고, 블록이 섞여 있으면 블록 시작 주소순으로 한 번만 재배열
+// (이후 레코드 순서가 곧 주소순이므로 Pass2는 한 번만 순차적으로 읽음)
+class IntermediateReader {
+private:
+    const unsigned char* recordBase;
+    size_t recordSize;
+    const char* stringBase;
+    size_t stringSize;
+    const unsigned char* groupedBase;  // 블록순으로 재배열한 레코드 (없으면 nullptr)
+    size_t groupedSize;
+    const IntermediateFileHeader* header;
+    const IntermediateRecord* records;
+    const int32_t* blockStarts;
+    const IntermediateSymbolName* symbolNames;
+    std::vector<int> symbolMap;  // 파일의 심볼 ID -> 현재 SYMTAB ID
+
+    void close();
+    bool validate(const OPTAB& optab, std::vector<uint64_t>& blockCounts, bool& inOrder) const;
+    bool groupByBlock(const std::string& spillFilename, const std::vector<uint64_t>& blockCounts);
+
+public:
+    IntermediateReader();
+    ~IntermediateReader();
+    IntermediateReader(const IntermediateReader&) = delete;
+    IntermediateReader& operator=(const IntermediateReader&) = delete;
+
+    bool open(const std::string& recordFilename, const std::string& stringFilename,
+              const OPTAB& optab);
+    // 파일의 심볼 이름을 symtab에 intern해 ID 변환표를 만듦
+    void bindSymbols(SYMTAB& symtab);
+    uint64_t size() const;
+    int getStartAddress() const;
+    int getProgramLength() const;
+    std::string getProgramName() const;
+    int getBlockCount() const;
+    int getBlockStart(int block) const;
+    // 레코드 하나를 최종 주소, 현재 SYMTAB ID로 복원 (index는 주소순)
+    void read(uint64_t index, IntermediateLine& line) const;
+    // index 이전 레코드와 그 문자열이 차지한 페이지를 내려놓음 (RSS 유지)
+    void release(uint64_t index) const;
 };
 
 class Pass1 {
@@ -78,30 +637,199 @@ private:
     int locctr;
     int startAddr;
     std::string programName;
+
+    // 프로그램 블록 테이블
+    std::vector<ProgramBlock> blocks;
+    int currentBlock;
+    bool packReservations;  // RESW/RESB를 별도의 마지막 블록으로 모음
+    int reserveBlock;       // 그 블록 번호 (-1이면 아직 없음)
     
-    int getInstructionLength(const std::string& mnemonic, const std::string& operand);
-    int getDirectiveLength(const std::string& directive, const std::string& operand, SYMTAB* symtab);
+    // 조건부 어셈블리: 비활성 구간은 opcode 필드만 보고 건너뜀 (중간파일 라인을 만들지 않음)
+    std::vector<ConditionalFrame> conditionals;
+    int skipDepth;          // 건너뛰는 구간 안에서 만난 (평가하지 않는) IF 중첩 수
+
+    Profiler* profiler;     // 파싱/Pass1 시간 분리 측정 (없으면 nullptr)
+    IntermediateWriter* spill;  // 있으면 intFile 대신 바이너리 중간파일로 내보냄
+    
+    void emit(const IntermediateLine& line);
+    bool finishSpill();
+    int findOrAddBlock(const std::string& name);
+    void assignBlockAddresses();
+    bool processLine(const SourceLine& parsed, int lineNum);  // END면 false
+    bool classifyOperand(IntermediateLine& line, const SourceLine& source, int lineNum);
+    int getInstructionLength(const IntermediateLine& line);
+    int getDirectiveLength(const IntermediateLine& line, const SourceLine& source, int lineNum);
+    bool inactive() const;
+    void skipLine(const char* opcode, size_t length, int lineNum);
+    void processConditional(const IntermediateLine& line, int lineNum);
+    bool evaluateCondition(const std::string& expr, int lineNum, bool& result);
+    bool evaluateTerm(const std::string& term, int lineNum, int& value);
+    void closeConditionals();
 
 public:
     Pass1(OPTAB* opt, SYMTAB* sym);
+    void setPackReservations(bool enable);
+    void setProfiler(Profiler* prof);
+    void setSpill(IntermediateWriter* writer);
     bool execute(const std::string& srcFilename);
+    // 중간파일의 라인 길이가 바뀐 뒤 주소, 블록, 라벨을 다시 배정
+    void relayout();
+    // 읽기 스레드 -> 파싱 스레드 -> Pass1을 SPSC 링으로 연결한 파이프라인 실행
+    bool executePipelined(const std::string& srcFilename);
     void writeIntFile(const std::string& intFilename);
     void printIntFile() const;
+    void printBlockTable() const;
+    int getBlockCount() const;
     int getProgramLength() const;
     int getStartAddress() const;
     int getFinalLocctr() const;
     // ======== [추가] Pass 2에 데이터를 전달하기 위한 함수 ========
     const std::vector<IntermediateLine>& getIntFile() const;
+    std::vector<IntermediateLine>& getIntFile();
     std::string getProgramName() const;
     // =======================================================
 };
 
+// ==================== TextRecordPacker ====================
+// T 레코드 묶기: 최대 길이 설정, 긴 데이터 분할, 좁은 주소 틈 채우기
+struct TextRecordOptions {
+    int maxLength = 30;      // 레코드당 최대 바이트 수 (1..255)
+    bool splitData = false;  // 데이터(WORD/BYTE)는 남은 칸을 채우고 다음 레코드로 이어감
+    int gapFill = 0;         // 이 바이트 수 이하의 주소 틈은 00으로 채워 레코드 유지
+    bool fillRecords = false;  // FILL 반복 구간을 F 레코드 하나로 압축 (더 짧을 때만)
+};
+
+class TextRecordPacker {
+private:
+    TextRecordOptions options;
+    std::vector<std::string> records;
+    std::ostream* sink;  // 있으면 닫힌 레코드를 모으지 않고 바로 씀
+    size_t recordCount;
+
+    // 열린 레코드 (T + 주소, 길이는 닫을 때 삽입)
+    std::string current;
+    int currentStart;
+    int currentLength;
+
+    // 요약 통계
+    int totalBytes;
+    int splitCount;   // 레코드 경계에서 나뉜 목적 코드 수
+    int gapBytes;     // 틈 채우기로 들어간 00 바이트 수
+    int fillCount;    // F 레코드 수
+    int fillBytes;    // F 레코드가 나타내는 바이트 수
+
+    void start(int loc);
+    void flush();
+    void write(const std::string& record);
+    void bridge(int loc, int need);  // 열린 레코드 끝과 loc 사이의 틈 처리
+
+public:
+    explicit TextRecordPacker(const TextRecordOptions& opts = TextRecordOptions());
+    // 목적 코드(16진 문자열)를 주소 loc에 추가, isData면 분할 허용 대상
+    void append(const std::string& objCode, int loc, bool isData);
+    // pattern(바이트열)을 count번 반복한 데이터 (FILL): 16진 문자열로 펼치지 않고 레코드에 바로 씀
+    void appendRun(const std::string& pattern, int count, int loc);
+    void setSink(std::ostream* out);
+    void finish();
+    const std::vector<std::string>& getRecords() const;
+    void printSummary(std::ostream& out = std::cout) const;
+};
+
+// ==================== Memory image ====================
+// 프로그램 주소 범위 전체를 그대로 담은 평면 이미지(IMGFILE)의 사이드카 헤더
+// (재배치는 적용하지 않음: startAddr에 적재한다고 가정, 호스트 바이트 순서)
+struct MemoryImageHeader {
+    char magic[4];         // "SXIM"
+    uint32_t version;
+    uint32_t loadAddress;  // 이미지 첫 바이트의 주소 (H 레코드 시작 주소)
+    uint32_t length;       // 이미지 바이트 수 (H 레코드 길이)
+    uint32_t entryPoint;   // E 레코드 실행 시작 주소
+    char name[8];          // 프로그램 이름 (NUL 채움)
+};
+
+// ==================== Optimizer ====================
+// Pass1과 Pass2 사이의 선택적 peephole 최적화 (--optimize)
+// 주소가 바뀌면 Pass1::relayout으로 라벨까지 다시 배정
+struct OptimizerChange {
+    std::string rule;
+    int location;        // 바뀌기 직전의 주소
+    std::string before;
+    std::string after;   // 비어 있으면 삭제
+    int bytesSaved;
+};
+
+class Optimizer {
+private:
+    // 체인을 따라 대상을 바꾼 점프 (주소 재배정 후 범위를 확인해야 확정)
+    struct JumpRetarget {
+        size_t line;                  // intFile 인덱스
+        int location;                 // 바뀌기 직전의 주소
+        std::string before;
+        int originalSym;
+        std::string originalOperand;
+    };
+
+    OPTAB* optab;
+    SYMTAB* symtab;
+    Pass1* pass1;
+    std::vector<OptimizerChange> changes;
+    std::vector<std::string> notes;  // 적용하지 못한 변환
+    int lengthBefore;
+    int lengthAfter;
+
+    void record(const std::string& rule, const IntermediateLine& line,
+                const std::string& after, int bytesSaved);
+    int removeRedundantLoads(std::vector<IntermediateLine>& lines);
+    int collapseJumpChains(std::vector<IntermediateLine>& lines, std::vector<JumpRetarget>& retargets);
+    void fitJumpChains(std::vector<IntermediateLine>& lines, const std::vector<JumpRetarget>& retargets);
+    int useClear(std::vector<IntermediateLine>& lines);
+    int shrinkExtended(std::vector<IntermediateLine>& lines);
+
+public:
+    Optimizer(OPTAB* opt, SYMTAB* sym, Pass1* p1);
+    void run();
+    void printReport() const;
+};
+
+// ==================== Stripper ====================
+// 도달할 수 없는 코드/데이터 제거 (--strip)
+// 라벨 하나부터 같은 블록의 다음 라벨 직전까지를 한 구간으로 보고, END의 시작 심볼에서 출발해
+// 심볼 참조와 이어서 실행되는 다음 구간(fallthrough)을 따라 도달한 구간만 남김
+struct StrippedRegion {
+    std::string label;
+    int location;        // 지우기 직전의 주소
+    int lines;
+    int bytes;
+};
+
+class Stripper {
+private:
+    struct Region {
+        int labelId;         // 라벨 심볼 ID (블록 첫머리의 라벨 없는 구간은 -1)
+        int next;            // 같은 블록의 다음 구간 (-1이면 없음)
+        bool fallsThrough;   // 마지막 명령어가 J/RSUB가 아니면 다음 구간으로 이어짐
+        bool hasCode;
+    };
+
+    OPTAB* optab;
+    SYMTAB* symtab;
+    Pass1* pass1;
+    std::vector<StrippedRegion> removed;
+    int lengthBefore;
+    int lengthAfter;
+
+public:
+    Stripper(OPTAB* opt, SYMTAB* sym, Pass1* p1);
+    void run();
+    void printReport() const;
+};
+
 // ==================== [신규] Pass2 ====================
 class Pass2 {
 private:
     OPTAB* optab;
     SYMTAB* symtab;
-    std::vector<IntermediateLine> intFile; // Pass1로부터 복사본
+    std::vector<IntermediateLine>* intFile; // Pass1 소유, objcode만 채움 (중간파일 모드면 nullptr)
     int startAddr;
     int programLength;
     std::string programName;
@@ -109,16 +837,19 @@ private:
 
     // H, T, E 레코드
     std::string headerRecord;
-    std::vector<std::string> textRecords;
+    TextRecordPacker textPacker;          // T 레코드
+    std::vector<std::string> modRecords;  // M 레코드 (재배치 정보)
+    std::ofstream modSpill;               // 중간파일 모드에서는 M 레코드를 임시 파일로
     std::string endRecord;
 
-    // T 레코드 생성을 위한 버퍼
-    std::string currentTextRecord;
-    int currentTextRecordStartAddr;
-    int currentTextRecordLength; // 바이트 단위
-    
-    // 레지스터 번호
-    std::map<std::string, int> registers;
+    // Format 3/4 인코딩 직전의 필드 (--check는 여기까지만 계산)
+    struct Format3Fields {
+        int n = 0, i = 0, x = 0, b = 0, p = 0, e = 0;
+        int disp = 0;              // 12비트 변위 또는 20비트 주소
+        bool relocatable = false;  // 재배치 심볼을 절대 주소로 담음 (M 레코드 필요)
+    };
+    bool resolveFormat3(const IntermediateLine& line, int nextLoc, Format3Fields& fields);
+    void checkLine(const IntermediateLine& line);
 
     // 목적 코드 생성
     std::string generateObjectCode(IntermediateLine& line, int nextLoc);
@@ -127,23 +858,93 @@ private:
     std::string handleFormat3(const IntermediateLine& line, int nextLoc);
     std::string handleDirective(const IntermediateLine& line);
 
-    // T 레코드 관리
-    void startNewTextRecord(int loc);
-    void appendToTextRecord(const std::string& objCode, int loc);
-    void flushTextRecord();
+    // 라인 단위 처리 (메모리/중간파일 모드 공통)
+    void beginProgram();
+    void processLine(IntermediateLine& line);
+    void processFill(IntermediateLine& line);  // 펼친 목적 코드 문자열을 만들지 않음
+    void endProgram(const IntermediateLine* endLine);
+
+    // M 레코드 관리 (주소는 프로그램 시작 기준, 길이는 half-byte 단위)
+    void addModRecord(int loc, int halfBytes);
+
+    LineMap* lineMap;  // 있으면 코드를 만든 라인의 주소 구간을 기록
+
+    // 메모리 이미지 (16진 문자열을 거치지 않고 인코딩한 값을 바로 기록)
+    bool emitImage;
+    std::vector<unsigned char> image;
+    void storeImage(int loc, long long value, int bytes);
+    void fillImage(int loc, const std::string& pattern, int length);
 
     // 유틸리티
-    std::string intToHex(int val, int width) const;
-    int hexStringToInt(const std::string& hexStr) const;
-    int getRegisterNum(const std::string& reg) const;
+    std::string intToHex(long long val, int width) const;
 
 public:
-    Pass2(OPTAB* opt, SYMTAB* sym, const std::vector<IntermediateLine>& intF, 
+    Pass2(OPTAB* opt, SYMTAB* sym, std::vector<IntermediateLine>& intF,
           int start, int length, const std::string& progName);
+    Pass2(OPTAB* opt, SYMTAB* sym, const IntermediateReader& reader);
+    void setTextRecordOptions(const TextRecordOptions& opts);
+    void setEmitImage(bool enable);
+    void setLineMap(LineMap* map);
     bool execute();
+    // 목적 코드, T 레코드, 파일 출력 없이 심볼 해석과 변위 범위만 검사 (--check)
+    bool check();
+    // 중간파일을 블록 주소순으로 훑으며 OBJFILE을 바로 써 나감 (레코드를 메모리에 모으지 않음)
+    bool executeOutOfCore(const IntermediateReader& reader, const std::string& objFilename);
     void writeObjFile(const std::string& objFilename) const;
-    void printObjFile() const;
-    void printListingFile() const; // INTFILE에 objcode가 채워진 것을 출력
+    bool writeImageFile(const std::string& imgFilename, const std::string& headerFilename) const;
+    void printObjFile(std::ostream& out = std::cout) const;
+    void printTextRecordSummary(std::ostream& out = std::cout) const;
+    void printListingFile(std::ostream& out = std::cout) const; // INTFILE에 objcode가 채워진 것을 출력
+};
+
+// ==================== Loader ====================
+// OBJFILE(H/T/M/E)을 읽어 지정한 주소에 재배치하여 적재
+class Loader {
+private:
+    struct ModRecord {
+        int offset;     // 프로그램 시작 기준 상대 주소
+        int halfBytes;  // 수정할 필드 길이 (05: Format 4, 06: WORD)
+    };
+
+    std::vector<unsigned char> memory;
+    int entryPoint;
+    int programLength;  // H 레코드의 길이
+
+    static const int PAGE_SIZE = 4096;
+
+    bool applyModifications(std::vector<ModRecord>& mods, int base, int length, int delta);
+
+public:
+    explicit Loader(int memorySize = 1 << 20);  // SIC/XE 1MB 주소 공간
+    bool load(const std::string& objFilename, int loadAddr);
+    int getEntryPoint() const;
+    int getProgramLength() const;
+    const std::vector<unsigned char>& getMemory() const;
+    void dumpMemory(int address, int length) const;
+};
+
+// ==================== Disassembler ====================
+// OBJFILE(H/T/E)을 읽어 Format 1/2/3/4 명령어로 역어셈블
+class Disassembler {
+private:
+    // 첫 바이트(opcode 상위 6비트 + n,i)로 바로 찾는 256칸 디코드 테이블
+    const InstructionInfo* decodeTable[256];
+    std::map<int, std::string> symbols;  // 주소 -> 심볼 (SYMTAB 덤프가 있을 때)
+
+    struct Segment {
+        int address;
+        std::vector<unsigned char> bytes;
+        int repeat;  // F 레코드: bytes(패턴)를 repeat번 반복 (T 레코드면 0)
+    };
+
+    void decodeSegment(const Segment& seg, std::string& out) const;
+    size_t decodeInstruction(const unsigned char* code, size_t avail, int loc, std::string& out) const;
+    void appendAddress(int addr, std::string& out) const;
+
+public:
+    explicit Disassembler(const OPTAB* optab);
+    bool loadSymbols(const std::string& symtabFilename);
+    bool disassemble(const std::string& objFilename, std::ostream& out) const;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,397 @@
+#include "../include/assembler.h"
+#include <cerrno>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// 항목 파일 형식: [MAGIC(8)][개수 u32] 이후 항목마다 [이름 길이 u32][데이터 길이 u64][이름][데이터]
+// 이름이 빈 항목은 리스팅 텍스트
+const char ENTRY_MAGIC[8] = {'S', 'X', 'C', 'A', 'C', 'H', 'E', '1'};
+const char* ENTRY_SUFFIX = ".entry";
+const char* STATS_FILE = "STATS";
+const int STALE_TEMP_SECONDS = 600;  // 이보다 오래된 임시 파일은 중단된 쓰기로 보고 삭제
+
+// FNV-1a 128비트: prime = 2^88 + 0x13B, offset basis = 0x6C62272E07BB014262B821756295C58D
+// 표준 C++에는 128비트 정수가 없으므로 상태를 64비트 두 조각(hi:lo)으로 계산
+const uint64_t FNV128_PRIME_LOW = 0x13B;
+const int FNV128_PRIME_SHIFT = 88 - 64;  // 2^88은 hi 쪽으로 24비트 시프트
+const uint64_t FNV128_OFFSET_HIGH = 0x6C62272E07BB0142ULL;
+const uint64_t FNV128_OFFSET_LOW = 0x62B821756295C58DULL;
+
+// (hi:lo) *= prime (mod 2^128)
+inline void multiplyPrime(uint64_t& high, uint64_t& low) {
+    // lo * 0x13B의 상위 64비트 (lo를 32비트씩 나눠 곱한 뒤 자리올림만 모음)
+    uint64_t lowPart = (low & 0xFFFFFFFFULL) * FNV128_PRIME_LOW;
+    uint64_t highPart = (low >> 32) * FNV128_PRIME_LOW;
+    uint64_t carry = (highPart + (lowPart >> 32)) >> 32;
+    high = high * FNV128_PRIME_LOW + carry + (low << FNV128_PRIME_SHIFT);
+    low = low * FNV128_PRIME_LOW;
+}
+
+bool endsWith(const std::string& str, const std::string& suffix) {
+    return str.size() >= suffix.size() &&
+           str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool copyBytes(std::istream& in, std::ostream& out, uint64_t length) {
+    std::vector<char> buffer(1 << 16);
+    while (length > 0) {
+        std::streamsize chunk = static_cast<std::streamsize>(
+            std::min<uint64_t>(length, buffer.size()));
+        if (!in.read(buffer.data(), chunk)) return false;
+        if (!out.write(buffer.data(), chunk)) return false;
+        length -= static_cast<uint64_t>(chunk);
+    }
+    return true;
+}
+
+struct EntryItem {
+    std::string name;
+    uint64_t offset;  // 항목 파일 안에서 데이터 시작 위치
+    uint64_t length;
+};
+
+// 헤더를 모두 훑어 크기가 파일과 맞는지 먼저 확인 (복원 도중에 깨진 항목을 발견하지 않도록)
+bool readIndex(std::ifstream& file, uint64_t fileSize, std::vector<EntryItem>& items) {
+    char magic[8];
+    uint32_t count = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, ENTRY_MAGIC, sizeof(magic)) != 0 ||
+        !file.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        return false;
+    }
+    uint64_t pos = sizeof(magic) + sizeof(count);
+    for (uint32_t k = 0; k < count; ++k) {
+        uint32_t nameLength = 0;
+        uint64_t dataLength = 0;
+        if (!file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength)) ||
+            !file.read(reinterpret_cast<char*>(&dataLength), sizeof(dataLength))) {
+            return false;
+        }
+        pos += sizeof(nameLength) + sizeof(dataLength);
+        if (nameLength > 4096 || pos + nameLength + dataLength > fileSize) return false;
+        EntryItem item;
+        item.name.resize(nameLength);
+        if (!file.read(&item.name[0], nameLength)) return false;
+        pos += nameLength;
+        item.offset = pos;
+        item.length = dataLength;
+        items.push_back(item);
+        pos += dataLength;
+        file.seekg(static_cast<std::streamoff>(pos));
+    }
+    return pos == fileSize;
+}
+
+}  // namespace
+
+// ============================================================
+// ContentHash
+// ============================================================
+ContentHash::ContentHash() : high(FNV128_OFFSET_HIGH), low(FNV128_OFFSET_LOW) {}
+
+void ContentHash::update(const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t h = high, l = low;
+    for (size_t k = 0; k < size; ++k) {
+        l ^= bytes[k];
+        multiplyPrime(h, l);
+    }
+    high = h;
+    low = l;
+}
+
+void ContentHash::updateString(const std::string& str) {
+    uint64_t length = str.size();
+    update(&length, sizeof(length));
+    update(str.data(), str.size());
+}
+
+bool ContentHash::updateFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open file for hashing: " << filename << std::endl;
+        return false;
+    }
+    updateString(filename);
+    std::vector<char> buffer(1 << 20);
+    uint64_t size = 0;
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        update(buffer.data(), static_cast<size_t>(file.gcount()));
+        size += static_cast<uint64_t>(file.gcount());
+    }
+    update(&size, sizeof(size));
+    return true;
+}
+
+std::string ContentHash::hex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string out(32, '0');
+    for (int k = 0; k < 16; ++k) {
+        out[k] = digits[(high >> (60 - 4 * k)) & 0xF];
+        out[16 + k] = digits[(low >> (60 - 4 * k)) & 0xF];
+    }
+    return out;
+}
+
+// ============================================================
+// AssemblyCache
+// ============================================================
+AssemblyCache::AssemblyCache(const std::string& dir, uint64_t limitBytes)
+    : directory(dir), maxBytes(limitBytes), hits(0), misses(0), stores(0), evictions(0),
+      recorded{0, 0, 0, 0} {}
+
+bool AssemblyCache::open() {
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        std::cerr << "Error: Cannot create cache directory: " << directory << " ("
+                  << std::strerror(errno) << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::string AssemblyCache::entryPath(const std::string& key) const {
+    return directory + "/" + key + ENTRY_SUFFIX;
+}
+
+// ============================================================
+// 조회: 적중하면 출력 파일을 복원하고 수정 시각을 갱신 (LRU 순서)
+// 모든 항목을 임시 파일로 읽어 낸 뒤에만 rename하므로 도중에 실패해도 기존 출력은 그대로
+// ============================================================
+bool AssemblyCache::lookup(const std::string& key, std::string& listing,
+                           const std::function<std::string(const std::string&)>& pathFor) {
+    std::string path = entryPath(key);
+    std::ifstream file(path, std::ios::binary);
+    struct stat info;
+    if (!file.is_open() || ::stat(path.c_str(), &info) != 0) {
+        misses++;
+        return false;
+    }
+
+    std::vector<EntryItem> items;
+    if (!readIndex(file, static_cast<uint64_t>(info.st_size), items)) {
+        std::cerr << "Warning: Discarding corrupt cache entry: " << path << std::endl;
+        ::unlink(path.c_str());
+        misses++;
+        return false;
+    }
+
+    file.clear();
+    std::string suffix = ".cache." + std::to_string(::getpid());
+    std::vector<std::pair<std::string, std::string>> restored;  // 임시 파일 -> 출력 경로
+    bool ok = true;
+    for (const EntryItem& item : items) {
+        file.seekg(static_cast<std::streamoff>(item.offset));
+        if (item.name.empty()) {
+            listing.resize(item.length);
+            ok = file.read(&listing[0], static_cast<std::streamsize>(item.length)).good();
+        } else {
+            std::string target = pathFor(item.name);
+            std::string temp = target + suffix;
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            restored.emplace_back(temp, target);
+            ok = out.is_open() && copyBytes(file, out, item.length);
+            out.close();
+            ok = ok && !out.fail();
+        }
+        if (!ok) {
+            std::cerr << "Warning: Cannot restore cache entry, discarding: " << path << std::endl;
+            break;
+        }
+    }
+    for (const auto& output : restored) {
+        if (ok && std::rename(output.first.c_str(), output.second.c_str()) != 0) {
+            std::cerr << "Error: Cannot restore cached file: " << output.second << std::endl;
+            ok = false;
+        }
+        if (!ok) std::remove(output.first.c_str());
+    }
+    if (!ok) {
+        ::unlink(path.c_str());
+        listing.clear();
+        misses++;
+        return false;
+    }
+
+    ::utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+    hits++;
+    return true;
+}
+
+// ============================================================
+// 저장: 같은 디렉터리의 임시 파일에 쓴 뒤 rename (동시에 같은 키를 써도 한쪽이 통째로 이김)
+// ============================================================
+bool AssemblyCache::store(const std::string& key, const std::vector<std::string>& files,
+                          const std::string& listing) {
+    uint64_t total = listing.size();
+    for (const auto& name : files) {
+        struct stat info;
+        if (::stat(name.c_str(), &info) != 0) {
+            std::cerr << "Error: Cannot read output for cache: " << name << std::endl;
+            return false;
+        }
+        total += static_cast<uint64_t>(info.st_size);
+    }
+    if (total > maxBytes) {
+        std::cout << "Cache: result (" << total << " bytes) exceeds the cache size limit, not stored"
+                  << std::endl;
+        return false;
+    }
+
+    std::string temp = directory + "/.tmp." + std::to_string(::getpid()) + "." + key;
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot write cache entry: " << temp << std::endl;
+        return false;
+    }
+
+    auto writeHeader = [&out](const std::string& name, uint64_t length) {
+        uint32_t nameLength = static_cast<uint32_t>(name.size());
+        out.write(reinterpret_cast<const char*>(&nameLength), sizeof(nameLength));
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(name.data(), name.size());
+    };
+
+    uint32_t count = static_cast<uint32_t>(files.size() + 1);
+    out.write(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    bool ok = true;
+    for (const auto& name : files) {
+        std::ifstream in(name, std::ios::binary);
+        struct stat info;
+        ok = in.is_open() && ::stat(name.c_str(), &info) == 0;
+        if (!ok) break;
+        writeHeader(name, static_cast<uint64_t>(info.st_size));
+        ok = copyBytes(in, out, static_cast<uint64_t>(info.st_size));
+        if (!ok) break;
+    }
+    if (ok) {
+        writeHeader("", listing.size());
+        out.write(listing.data(), listing.size());
+    }
+    out.close();
+    if (!ok || !out || std::rename(temp.c_str(), entryPath(key).c_str()) != 0) {
+        std::cerr << "Error: Cannot write cache entry: " << entryPath(key) << std::endl;
+        std::remove(temp.c_str());
+        return false;
+    }
+    stores++;
+    evict(key);
+    return true;
+}
+
+// ============================================================
+// LRU 정리: 전체 크기가 제한을 넘으면 수정 시각이 가장 오래된 항목부터 삭제
+// ============================================================
+void AssemblyCache::evict(const std::string& keep) {
+    DIR* dir = ::opendir(directory.c_str());
+    if (dir == nullptr) return;
+
+    struct Entry {
+        std::string path;
+        uint64_t size;
+        struct timespec mtime;
+    };
+    std::vector<Entry> entries;
+    uint64_t total = 0;
+    time_t now = ::time(nullptr);
+    std::string keepName = keep + ENTRY_SUFFIX;
+    while (struct dirent* ent = ::readdir(dir)) {
+        std::string name = ent->d_name;
+        std::string path = directory + "/" + name;
+        struct stat info;
+        if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) continue;
+        if (name.compare(0, 5, ".tmp.") == 0) {
+            if (now - info.st_mtime > STALE_TEMP_SECONDS) ::unlink(path.c_str());
+            continue;
+        }
+        if (!endsWith(name, ENTRY_SUFFIX)) continue;
+        total += static_cast<uint64_t>(info.st_size);
+        if (name != keepName) {
+            entries.push_back({path, static_cast<uint64_t>(info.st_size), info.st_mtim});
+        }
+    }
+    ::closedir(dir);
+    if (total <= maxBytes) return;
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+        if (a.mtime.tv_sec != b.mtime.tv_sec) return a.mtime.tv_sec < b.mtime.tv_sec;
+        return a.mtime.tv_nsec < b.mtime.tv_nsec;
+    });
+    for (const Entry& entry : entries) {
+        if (total <= maxBytes) break;
+        // 다른 프로세스가 먼저 지웠으면 건너뜀
+        if (::unlink(entry.path.c_str()) == 0) {
+            evictions++;
+        }
+        total -= entry.size;
+    }
+}
+
+// ============================================================
+// 통계: 여러 프로세스가 같은 캐시를 쓰므로 STATS 파일은 flock으로 잠그고 갱신
+// (감시 모드는 조립마다 부르므로 지난번에 반영한 뒤로 늘어난 만큼만 더함)
+// ============================================================
+void AssemblyCache::finish() {
+    int current[4] = {hits, misses, stores, evictions};
+    if (std::equal(current, current + 4, recorded)) return;
+    std::string path = directory + "/" + STATS_FILE;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    if (::flock(fd, LOCK_EX) == 0) {
+        char buffer[256] = {0};
+        ssize_t length = ::pread(fd, buffer, sizeof(buffer) - 1, 0);
+        unsigned long long total[4] = {0, 0, 0, 0};
+        if (length > 0) {
+            std::sscanf(buffer, "hits %llu misses %llu stores %llu evictions %llu", &total[0],
+                        &total[1], &total[2], &total[3]);
+        }
+        for (int k = 0; k < 4; ++k) {
+            total[k] += static_cast<unsigned long long>(current[k] - recorded[k]);
+            recorded[k] = current[k];
+        }
+        std::string text = "hits " + std::to_string(total[0]) + " misses " +
+                           std::to_string(total[1]) + " stores " + std::to_string(total[2]) +
+                           " evictions " + std::to_string(total[3]) + "\n";
+        if (::ftruncate(fd, 0) == 0) {
+            ssize_t written = ::pwrite(fd, text.data(), text.size(), 0);
+            (void)written;
+        }
+        ::flock(fd, LOCK_UN);
+    }
+    ::close(fd);
+}
+
+void AssemblyCache::printStats() const {
+    uint64_t entries = 0;
+    uint64_t bytes = 0;
+    if (DIR* dir = ::opendir(directory.c_str())) {
+        while (struct dirent* ent = ::readdir(dir)) {
+            std::string name = ent->d_name;
+            struct stat info;
+            if (!endsWith(name, ENTRY_SUFFIX) ||
+                ::stat((directory + "/" + name).c_str(), &info) != 0) {
+                continue;
+            }
+            entries++;
+            bytes += static_cast<uint64_t>(info.st_size);
+        }
+        ::closedir(dir);
+    }
+
+    std::string totals = "(none)";
+    std::ifstream file(directory + "/" + STATS_FILE);
+    if (file.is_open()) {
+        std::getline(file, totals);
+    }
+    std::cout << "\nCache: " << directory << std::endl;
+    std::cout << "  this run : hits " << hits << " misses " << misses << " stores " << stores
+              << " evictions " << evictions << std::endl;
+    std::cout << "  all runs : " << totals << std::endl;
+    std::cout << "  size     : " << entries << " entries, " << bytes << " of " << maxBytes
+              << " bytes" << std::endl;
+}
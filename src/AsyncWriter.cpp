@@ -0,0 +1,43 @@
+#include "../include/assembler.h"
+
+AsyncWriter::AsyncWriter() : tasks(64), closed(false), cancel(false) {
+    worker = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter() {
+    finish();
+}
+
+void AsyncWriter::submit(std::function<void()> task) {
+    tasks.push(task, cancel);
+    // 작업자가 큐를 확인한 뒤 잠들기 전 사이에 알림이 사라지지 않도록 잠금을 거쳐서 깨움
+    { std::lock_guard<std::mutex> lock(mutex); }
+    wake.notify_one();
+}
+
+void AsyncWriter::finish() {
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed.store(true, std::memory_order_release);
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void AsyncWriter::run() {
+    std::function<void()> task;
+    while (true) {
+        bool popped = false;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] {
+                popped = tasks.tryPop(task);
+                return popped || closed.load(std::memory_order_acquire);
+            });
+        }
+        // 닫힌 뒤에도 남은 작업을 먼저 꺼내므로 비었을 때만 종료
+        if (!popped) break;
+        task();
+    }
+}
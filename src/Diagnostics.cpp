@@ -0,0 +1,192 @@
+#include "../include/assembler.h"
+#include <iterator>
+#include <mutex>
+
+namespace {
+
+// 스레드마다 하나, 해당 스레드만 추가하므로 잠금 불필요 (Trace와 같은 방식)
+struct DiagnosticBuffer {
+    std::vector<Diagnostic> items;
+    DiagnosticBuffer* next;
+};
+
+std::atomic<DiagnosticBuffer*> g_buffers(nullptr);
+std::atomic<int> g_errors(0);
+std::atomic<int> g_warnings(0);
+std::atomic<int> g_maxErrors(100);
+std::atomic<bool> g_limitReported(false);
+
+// flush 이후의 상태 (flush/writeJson/reset은 한 스레드에서만 호출)
+std::mutex g_mutex;
+std::string g_sourceFile;
+std::vector<Diagnostic> g_flushed;
+
+DiagnosticBuffer* threadBuffer() {
+    thread_local DiagnosticBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        buffer = new DiagnosticBuffer();
+        buffer->next = g_buffers.load(std::memory_order_relaxed);
+        while (!g_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        }
+    }
+    return buffer;
+}
+
+const char* severityName(Severity severity) {
+    switch (severity) {
+    case Severity::NOTE:
+        return "note";
+    case Severity::WARNING:
+        return "warning";
+    default:
+        return "error";
+    }
+}
+
+void writeEscaped(std::ostream& out, const std::string& str) {
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                << static_cast<int>(c) << std::dec << std::setfill(' ');
+        } else {
+            out << c;
+        }
+    }
+}
+
+}  // namespace
+
+void Diagnostics::setSourceFile(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    g_sourceFile = filename;
+}
+
+void Diagnostics::setMaxErrors(int limit) {
+    g_maxErrors.store(limit, std::memory_order_relaxed);
+}
+
+// ============================================================
+// 보고: 제한에 걸린 뒤의 진단은 버림 (오류 수는 계속 셈)
+// ============================================================
+void Diagnostics::report(Severity severity, const char* code, int line, int address,
+                         const std::string& message) {
+    if (shouldAbort()) {
+        if (severity == Severity::ERROR) g_errors.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    if (severity == Severity::ERROR) {
+        int count = g_errors.fetch_add(1, std::memory_order_relaxed) + 1;
+        threadBuffer()->items.push_back({severity, code, line, address, message});
+        int limit = g_maxErrors.load(std::memory_order_relaxed);
+        if (limit > 0 && count >= limit && !g_limitReported.exchange(true)) {
+            threadBuffer()->items.push_back({Severity::NOTE, "", line, -1,
+                                             "too many errors (" + std::to_string(limit) +
+                                                 "), stopping"});
+        }
+        return;
+    }
+    if (severity == Severity::WARNING) {
+        g_warnings.fetch_add(1, std::memory_order_relaxed);
+    }
+    threadBuffer()->items.push_back({severity, code, line, address, message});
+}
+
+void Diagnostics::error(const char* code, int line, const std::string& message, int address) {
+    report(Severity::ERROR, code, line, address, message);
+}
+
+void Diagnostics::warning(const char* code, int line, const std::string& message, int address) {
+    report(Severity::WARNING, code, line, address, message);
+}
+
+bool Diagnostics::shouldAbort() {
+    int limit = g_maxErrors.load(std::memory_order_relaxed);
+    return limit > 0 && g_errors.load(std::memory_order_relaxed) >= limit;
+}
+
+int Diagnostics::errorCount() {
+    return g_errors.load(std::memory_order_relaxed);
+}
+
+int Diagnostics::warningCount() {
+    return g_warnings.load(std::memory_order_relaxed);
+}
+
+// ============================================================
+// 출력: 사람이 읽는 형식 (file:line: severity[code]: message)
+// ============================================================
+void Diagnostics::flush(std::ostream& out) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::vector<Diagnostic> batch;
+    for (DiagnosticBuffer* buffer = g_buffers.load(std::memory_order_acquire); buffer != nullptr;
+         buffer = buffer->next) {
+        std::move(buffer->items.begin(), buffer->items.end(), std::back_inserter(batch));
+        buffer->items.clear();
+    }
+    if (batch.empty()) return;
+
+    // 라인 없는 진단(제한 안내 등)은 맨 뒤로
+    std::stable_sort(batch.begin(), batch.end(), [](const Diagnostic& a, const Diagnostic& b) {
+        return (a.line == 0 ? INT32_MAX : a.line) < (b.line == 0 ? INT32_MAX : b.line);
+    });
+
+    // 한 번에 쓰도록 문자열로 모음
+    std::ostringstream text;
+    for (const Diagnostic& d : batch) {
+        if (d.line > 0) {
+            text << g_sourceFile << ":" << d.line << ": ";
+        }
+        text << severityName(d.severity);
+        if (d.code[0] != '\0') text << "[" << d.code << "]";
+        text << ": " << d.message;
+        if (d.address >= 0) {
+            text << " (at 0x" << std::hex << std::uppercase << std::setw(6) << std::setfill('0')
+                 << d.address << std::dec << std::setfill(' ') << ")";
+        }
+        text << '\n';
+    }
+    text << errorCount() << " error(s), " << warningCount() << " warning(s)\n";
+    out << text.str();
+    out.flush();
+
+    std::move(batch.begin(), batch.end(), std::back_inserter(g_flushed));
+}
+
+bool Diagnostics::writeJson(const std::string& filename) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot write diagnostics file: " << filename << std::endl;
+        return false;
+    }
+    file << "{\"file\":\"";
+    writeEscaped(file, g_sourceFile);
+    file << "\",\"errors\":" << errorCount() << ",\"warnings\":" << warningCount()
+         << ",\"diagnostics\":[";
+    for (size_t k = 0; k < g_flushed.size(); ++k) {
+        const Diagnostic& d = g_flushed[k];
+        file << (k == 0 ? "\n" : ",\n");
+        file << "{\"severity\":\"" << severityName(d.severity) << "\",\"code\":\"" << d.code
+             << "\",\"line\":" << d.line << ",\"address\":" << d.address << ",\"message\":\"";
+        writeEscaped(file, d.message);
+        file << "\"}";
+    }
+    file << "\n]}\n";
+    file.close();
+    return static_cast<bool>(file);
+}
+
+void Diagnostics::reset() {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (DiagnosticBuffer* buffer = g_buffers.load(std::memory_order_acquire); buffer != nullptr;
+         buffer = buffer->next) {
+        buffer->items.clear();
+    }
+    g_flushed.clear();
+    g_errors.store(0);
+    g_warnings.store(0);
+    g_limitReported.store(false);
+}
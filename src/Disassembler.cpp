@@ -0,0 +1,348 @@
+#include "../include/assembler.h"
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+const char* REGISTER_NAMES[16] = {"A", "X", "L", "B", "S", "T", "F", "?",
+                                  "PC", "SW", "?", "?", "?", "?", "?", "?"};
+
+// 16진수 글자 -> 값 테이블 (잘못된 글자는 -1)
+struct HexTable {
+    signed char value[256];
+    HexTable() {
+        for (int c = 0; c < 256; ++c) value[c] = -1;
+        for (int c = 0; c < 10; ++c) value['0' + c] = static_cast<signed char>(c);
+        for (int c = 0; c < 6; ++c) {
+            value['A' + c] = static_cast<signed char>(10 + c);
+            value['a' + c] = static_cast<signed char>(10 + c);
+        }
+    }
+};
+const HexTable HEX;
+
+bool parseHex(const char* p, int len, int& value) {
+    value = 0;
+    for (int k = 0; k < len; ++k) {
+        int d = HEX.value[static_cast<unsigned char>(p[k])];
+        if (d < 0) return false;
+        value = (value << 4) | d;
+    }
+    return true;
+}
+
+void appendHex(std::string& out, unsigned int value, int width) {
+    for (int k = width - 1; k >= 0; --k) {
+        out += HEX_DIGITS[(value >> (k * 4)) & 0xF];
+    }
+}
+
+void appendDecimal(std::string& out, int value) {
+    char digits[16];
+    auto res = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, res.ptr);
+}
+
+// 고정 폭 칸 채우기 (iostream 조작자 대신 직접 패딩)
+// 칸 내용은 out에 바로 덧붙이고, column(칸 시작 위치)부터 잰 길이로 패딩만 맞춤
+void padColumn(std::string& out, size_t column, size_t width) {
+    size_t length = out.size() - column;
+    if (length < width) out.append(width - length, ' ');
+    else out += ' ';
+}
+
+}  // namespace
+
+Disassembler::Disassembler(const OPTAB* optab) {
+    for (int b = 0; b < 256; ++b) decodeTable[b] = nullptr;
+
+    // Format 3/4는 하위 2비트(n,i)와 무관하게 같은 명령어, Format 1/2는 정확한 바이트만
+    for (int id = 0; id < optab->size(); ++id) {
+        const InstructionInfo& info = optab->getInfo(id);
+        int base = info.opcodeValue & 0xFC;
+        if (info.format == 3) {
+            for (int ni = 0; ni < 4; ++ni) decodeTable[base | ni] = &info;
+        } else {
+            decodeTable[info.opcodeValue & 0xFF] = &info;
+        }
+    }
+}
+
+// SYMTAB::writeToFile 형식 (이름  0xHHHH  십진수) 또는 바이너리 스냅샷을 읽어 주소 -> 이름 맵 구성
+bool Disassembler::loadSymbols(const std::string& symtabFilename) {
+    // 바이너리 스냅샷이면 파싱 없이 엔트리를 그대로 사용
+    if (SymbolSnapshot::isSnapshotFile(symtabFilename)) {
+        SymbolSnapshot snapshot;
+        if (!snapshot.open(symtabFilename)) return false;
+        for (int k = 0; k < snapshot.size(); ++k) {
+            const SymbolSnapshot::Entry& e = snapshot.entry(k);
+            symbols.emplace(static_cast<int>(e.address), snapshot.nameOf(e));
+        }
+        std::cout << "Symbols loaded: " << symbols.size() << std::endl;
+        return true;
+    }
+
+    std::ifstream file(symtabFilename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open SYMTAB file: " << symtabFilename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string name, hex;
+        if (!(iss >> name >> hex) || hex.size() < 3 || hex.compare(0, 2, "0x") != 0) continue;
+        int addr = 0;
+        if (Parser::parseNumber(hex, addr, 16)) {
+            symbols.emplace(addr, name);  // 같은 주소면 먼저 나온 이름 사용
+        }
+    }
+    file.close();
+    std::cout << "Symbols loaded: " << symbols.size() << std::endl;
+    return true;
+}
+
+// ============================================================
+// OBJFILE 역어셈블
+// ============================================================
+bool Disassembler::disassemble(const std::string& objFilename, std::ostream& out) const {
+    // 파일 전체를 한 번에 읽고 레코드를 직접 스캔
+    std::ifstream file(objFilename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open object file: " << objFilename << std::endl;
+        return false;
+    }
+    file.seekg(0, std::ios::end);
+    std::string data(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0, std::ios::beg);
+    file.read(&data[0], data.size());
+    file.close();
+
+    std::string header;
+    std::string trailer;
+    std::vector<Segment> segments;
+    int lineNum = 0;
+
+    size_t pos = 0;
+    while (pos < data.size()) {
+        size_t eol = data.find('\n', pos);
+        if (eol == std::string::npos) eol = data.size();
+        const char* rec = data.data() + pos;
+        size_t len = eol - pos;
+        if (len > 0 && rec[len - 1] == '\r') len--;
+        pos = eol + 1;
+        lineNum++;
+        if (len == 0) continue;
+
+        if (rec[0] == 'H' && len >= 19) {
+            int start = 0, length = 0;
+            parseHex(rec + 7, 6, start);
+            parseHex(rec + 13, 6, length);
+            header = "; PROGRAM " + Parser::trim(std::string(rec + 1, 6)) + "  START ";
+            appendHex(header, start, 6);
+            header += "  LENGTH ";
+            appendHex(header, length, 6);
+            header += '\n';
+        } else if (rec[0] == 'T' && len >= 9) {
+            int addr = 0, count = 0;
+            if (!parseHex(rec + 1, 6, addr) || !parseHex(rec + 7, 2, count) ||
+                len < 9 + static_cast<size_t>(count) * 2) {
+                std::cerr << "Error at line " << lineNum << ": Invalid T record" << std::endl;
+                return false;
+            }
+            // 주소가 이어지는 T 레코드는 하나의 구간으로 합침 (레코드 경계에 걸친 명령어 처리)
+            if (segments.empty() || segments.back().repeat > 0 ||
+                segments.back().address + static_cast<int>(segments.back().bytes.size()) != addr) {
+                segments.push_back({addr, {}, 0});
+            }
+            std::vector<unsigned char>& bytes = segments.back().bytes;
+            const char* hex = rec + 9;
+            for (int k = 0; k < count; ++k) {
+                int hi = HEX.value[static_cast<unsigned char>(hex[k * 2])];
+                int lo = HEX.value[static_cast<unsigned char>(hex[k * 2 + 1])];
+                if (hi < 0 || lo < 0) {
+                    std::cerr << "Error at line " << lineNum << ": Invalid hex in T record" << std::endl;
+                    return false;
+                }
+                bytes.push_back(static_cast<unsigned char>((hi << 4) | lo));
+            }
+        } else if (rec[0] == 'F' && len >= 15) {
+            // 반복 데이터는 펼치지 않고 FILL 한 줄로 출력
+            int addr = 0, count = 0, patternLength = 0;
+            if (!parseHex(rec + 1, 6, addr) || !parseHex(rec + 7, 6, count) ||
+                !parseHex(rec + 13, 2, patternLength) ||
+                len < 15 + static_cast<size_t>(patternLength) * 2) {
+                std::cerr << "Error at line " << lineNum << ": Invalid F record" << std::endl;
+                return false;
+            }
+            segments.push_back({addr, {}, count});
+            const char* hex = rec + 15;
+            for (int k = 0; k < patternLength; ++k) {
+                int hi = HEX.value[static_cast<unsigned char>(hex[k * 2])];
+                int lo = HEX.value[static_cast<unsigned char>(hex[k * 2 + 1])];
+                if (hi < 0 || lo < 0) {
+                    std::cerr << "Error at line " << lineNum << ": Invalid hex in F record" << std::endl;
+                    return false;
+                }
+                segments.back().bytes.push_back(static_cast<unsigned char>((hi << 4) | lo));
+            }
+        } else if (rec[0] == 'E') {
+            int entry = 0;
+            trailer = "; ENTRY ";
+            if (len >= 7 && parseHex(rec + 1, 6, entry)) {
+                appendHex(trailer, entry, 6);
+                auto it = symbols.find(entry);
+                if (it != symbols.end()) trailer += " (" + it->second + ")";
+            }
+            trailer += '\n';
+        }
+        // M 등 나머지 레코드는 코드 해석에 영향 없음
+    }
+
+    out << header;
+    std::string buffer;
+    for (const auto& seg : segments) {
+        buffer.clear();
+        buffer.reserve(seg.bytes.size() * 16);
+        decodeSegment(seg, buffer);
+        out.write(buffer.data(), buffer.size());
+    }
+    out << trailer;
+    return true;
+}
+
+void Disassembler::decodeSegment(const Segment& seg, std::string& out) const {
+    if (seg.repeat > 0) {
+        appendHex(out, seg.address, 6);
+        out += "  ";
+        size_t column = out.size();
+        auto it = symbols.find(seg.address);
+        if (it != symbols.end()) out += it->second;
+        padColumn(out, column, 10);
+        column = out.size();
+        out += "FILL";
+        padColumn(out, column, 10);
+        appendDecimal(out, seg.repeat);
+        out += ",X'";
+        for (unsigned char byte : seg.bytes) appendHex(out, byte, 2);
+        out += "'\n";
+        return;
+    }
+    size_t offset = 0;
+    while (offset < seg.bytes.size()) {
+        offset += decodeInstruction(&seg.bytes[offset], seg.bytes.size() - offset,
+                                    seg.address + static_cast<int>(offset), out);
+    }
+}
+
+void Disassembler::appendAddress(int addr, std::string& out) const {
+    auto it = symbols.find(addr);
+    if (it != symbols.end()) {
+        out += it->second;
+    } else {
+        out += "0x";
+        appendHex(out, addr, addr > 0xFFFF ? 5 : 4);
+    }
+}
+
+// 명령어 하나를 해석해 out에 바로 한 줄 출력, 사용한 바이트 수 반환
+// (명령어마다 임시 문자열을 만들지 않도록 크기부터 정하고 칸을 순서대로 덧붙임)
+size_t Disassembler::decodeInstruction(const unsigned char* code, size_t avail, int loc,
+                                       std::string& out) const {
+    const InstructionInfo* info = decodeTable[code[0]];
+    size_t size = 0;  // 0이면 디코드할 수 없는 바이트
+    if (info != nullptr && info->format == 1) {
+        size = 1;
+    } else if (info != nullptr && info->format == 2 && avail >= 2) {
+        size = 2;
+    } else if (info != nullptr && info->format == 3 && avail >= 3) {
+        bool extended = (code[0] & 0x3) != 0 && (code[1] & 0x10) != 0;
+        if (!extended) size = 3;
+        else if (avail >= 4) size = 4;  // Format 4인데 바이트가 모자라면 0
+    }
+
+    // LOC  LABEL  MNEMONIC  OPERAND  OBJCODE
+    appendHex(out, loc, 6);
+    out += "  ";
+    size_t column = out.size();
+    auto it = symbols.find(loc);
+    if (it != symbols.end()) out += it->second;
+    padColumn(out, column, 10);
+
+    if (size == 0) {
+        // 디코드할 수 없는 바이트는 데이터로 출력
+        column = out.size();
+        out += "BYTE";
+        padColumn(out, column, 10);
+        column = out.size();
+        out += "X'";
+        appendHex(out, code[0], 2);
+        out += '\'';
+        padColumn(out, column, 20);
+        appendHex(out, code[0], 2);
+        out += '\n';
+        return 1;
+    }
+
+    const std::string& mnemonic = info->mnemonic;
+    column = out.size();
+    if (size == 4) out += '+';
+    out += mnemonic;
+    padColumn(out, column, 10);
+
+    column = out.size();
+    if (info->format == 2) {
+        int r1 = code[1] >> 4;
+        int r2 = code[1] & 0xF;
+        if (mnemonic == "SVC") {
+            appendDecimal(out, r1);
+        } else if (mnemonic == "SHIFTL" || mnemonic == "SHIFTR") {
+            out += REGISTER_NAMES[r1];
+            out += ',';
+            appendDecimal(out, r2 + 1);
+        } else if (mnemonic == "CLEAR" || mnemonic == "TIXR") {
+            out += REGISTER_NAMES[r1];
+        } else {
+            out += REGISTER_NAMES[r1];
+            out += ',';
+            out += REGISTER_NAMES[r2];
+        }
+    } else if (info->format == 3) {
+        int ni = code[0] & 0x3;
+        bool x = (code[1] & 0x80) != 0;
+        bool b = (code[1] & 0x40) != 0;
+        bool p = (code[1] & 0x20) != 0;
+        if (ni == 1) out += '#';
+        else if (ni == 2) out += '@';
+
+        if (ni == 0) {
+            // SIC 호환 형식: x + 15-bit 주소
+            appendAddress(((code[1] & 0x7F) << 8) | code[2], out);
+        } else if (size == 4) {
+            int addr = ((code[1] & 0xF) << 16) | (code[2] << 8) | code[3];
+            if (ni == 1 && symbols.find(addr) == symbols.end()) appendDecimal(out, addr);
+            else appendAddress(addr, out);
+        } else {
+            int disp = ((code[1] & 0xF) << 8) | code[2];
+            if (p) {
+                if (disp & 0x800) disp -= 0x1000;  // 12비트 부호 확장
+                appendAddress(loc + 3 + disp, out);
+            } else if (b) {
+                out += "(B)+";
+                appendDecimal(out, disp);
+            } else if (ni == 1) {
+                appendDecimal(out, disp);
+            } else if (mnemonic == "RSUB" && disp == 0 && ni == 3) {
+                // 피연산자 없음
+            } else {
+                appendAddress(disp, out);
+            }
+        }
+        if (x) out += ",X";
+    }
+    padColumn(out, column, 20);
+
+    for (size_t k = 0; k < size; ++k) appendHex(out, code[k], 2);
+    out += '\n';
+    return size;
+}
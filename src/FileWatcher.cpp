@@ -0,0 +1,89 @@
+#include "../include/assembler.h"
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace {
+
+const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_MOVED_TO;
+
+void splitPath(const std::string& path, std::string& dir, std::string& name) {
+    size_t slash = path.rfind('/');
+    if (slash == std::string::npos) {
+        dir = ".";
+        name = path;
+    } else {
+        dir = path.substr(0, slash);
+        name = path.substr(slash + 1);
+    }
+}
+
+}  // namespace
+
+FileWatcher::FileWatcher() : fd(inotify_init1(IN_CLOEXEC)) {
+    if (fd < 0) {
+        std::cerr << "Error: inotify is not available" << std::endl;
+    }
+}
+
+FileWatcher::~FileWatcher() {
+    if (fd >= 0) ::close(fd);
+}
+
+bool FileWatcher::add(const std::string& path) {
+    if (fd < 0) return false;
+    std::string dir, name;
+    splitPath(path, dir, name);
+
+    // 같은 디렉터리는 한 번만 등록 (inotify도 같은 wd를 돌려줌)
+    int wd = inotify_add_watch(fd, dir.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        std::cerr << "Error: Cannot watch directory: " << dir << std::endl;
+        return false;
+    }
+    directories[wd] = dir;
+    files.push_back(path);
+    return true;
+}
+
+// ============================================================
+// 이벤트 대기: 첫 이벤트는 무한정, 이후는 quietMillis마다 더 오는지 확인
+// ============================================================
+std::vector<std::string> FileWatcher::wait(int quietMillis) {
+    std::vector<std::string> changed;
+    if (fd < 0) return changed;
+
+    alignas(struct inotify_event) char buffer[4096];
+    int timeout = -1;
+    while (true) {
+        struct pollfd pfd = {fd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (ready == 0) {
+            break;  // 마지막 변경 후 조용해짐
+        }
+
+        ssize_t length = ::read(fd, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(p);
+            p += sizeof(struct inotify_event) + event->len;
+            auto dir = directories.find(event->wd);
+            if (dir == directories.end() || event->len == 0) continue;
+
+            std::string path = dir->second == "." ? std::string(event->name)
+                                                  : dir->second + "/" + event->name;
+            if (std::find(files.begin(), files.end(), path) != files.end() &&
+                std::find(changed.begin(), changed.end(), path) == changed.end()) {
+                changed.push_back(path);
+            }
+        }
+        // 감시 대상이 아닌 파일만 바뀌었으면 계속 무한정 대기
+        timeout = changed.empty() ? -1 : quietMillis;
+    }
+    return changed;
+}
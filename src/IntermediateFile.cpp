@@ -0,0 +1,444 @@
+#include "../include/assembler.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(IntermediateFileHeader) == 48, "IntermediateFileHeader layout");
+static_assert(sizeof(IntermediateRecord) == 56, "IntermediateRecord layout");
+
+namespace {
+
+const size_t IO_BUFFER_SIZE = 1 << 20;
+const uint32_t FORMAT_VERSION = 3;
+const uint64_t RELEASE_INTERVAL = 1 << 16;  // 검사/재배열 중 이만큼마다 지나간 페이지를 내려놓음
+const size_t GROUP_BATCH = 256;             // 재배열 시 블록마다 모아서 쓰는 레코드 수
+
+// 파일 전체를 읽기 전용으로 mmap (빈 파일이면 nullptr, size 0)
+bool mapFile(const std::string& filename, const unsigned char*& base, size_t& size) {
+    base = nullptr;
+    size = 0;
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open intermediate file: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: Cannot map intermediate file: " << filename << std::endl;
+            ::close(fd);
+            size = 0;
+            return false;
+        }
+        madvise(mapped, size, MADV_SEQUENTIAL);
+        base = static_cast<const unsigned char*>(mapped);
+    }
+    ::close(fd);
+    return true;
+}
+
+// [begin, begin + length) 안에 완전히 들어가는 페이지를 내려놓음
+void dropPages(const void* begin, size_t length) {
+    static const uintptr_t pageSize = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(begin) & ~(pageSize - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(begin) + length) & ~(pageSize - 1);
+    if (end > start) {
+        madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED);
+    }
+}
+
+// offset 위치에 전부 쓸 때까지 pwrite
+bool writeAt(int fd, const void* data, size_t size, off_t offset) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = pwrite(fd, bytes, size, offset);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<size_t>(written);
+        offset += written;
+    }
+    return true;
+}
+
+// 블록 번호를 시작 주소순으로 정렬 (주소가 같으면 번호순)
+std::vector<uint32_t> blocksByStart(const int32_t* blockStarts, uint32_t blockCount) {
+    std::vector<uint32_t> order(blockCount);
+    for (uint32_t b = 0; b < blockCount; ++b) {
+        order[b] = b;
+    }
+    std::stable_sort(order.begin(), order.end(), [blockStarts](uint32_t a, uint32_t b) {
+        return blockStarts[a] < blockStarts[b];
+    });
+    return order;
+}
+
+}  // namespace
+
+// ============================================================
+// IntermediateWriter
+// ============================================================
+IntermediateWriter::IntermediateWriter()
+    : recordBuffer(IO_BUFFER_SIZE), stringBuffer(IO_BUFFER_SIZE), count(0), stringBytes(0) {}
+
+bool IntermediateWriter::open(const std::string& recordFilename, const std::string& stringFilename) {
+    records.rdbuf()->pubsetbuf(recordBuffer.data(), recordBuffer.size());
+    strings.rdbuf()->pubsetbuf(stringBuffer.data(), stringBuffer.size());
+    records.open(recordFilename, std::ios::binary | std::ios::trunc);
+    strings.open(stringFilename, std::ios::binary | std::ios::trunc);
+    if (!records.is_open() || !strings.is_open()) {
+        std::cerr << "Error: Cannot write intermediate file: " << recordFilename << std::endl;
+        return false;
+    }
+    // 헤더 자리만 잡아 두고 finish에서 채움
+    IntermediateFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    records.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    count = 0;
+    stringBytes = 0;
+    return true;
+}
+
+void IntermediateWriter::append(const IntermediateLine& line) {
+    IntermediateRecord rec;
+    std::memset(&rec, 0, sizeof(rec));
+    const ParsedOperand& p = line.parsed;
+    rec.location = line.location;
+    rec.length = line.length;
+    rec.block = line.block;
+    rec.directive = static_cast<uint8_t>(line.directive);
+    rec.flags = (line.hasLocation ? IntermediateRecord::FLAG_HAS_LOCATION : 0) |
+                (p.indexed ? IntermediateRecord::FLAG_INDEXED : 0) |
+                (p.extended ? IntermediateRecord::FLAG_EXTENDED : 0) |
+                (p.isNumber ? IntermediateRecord::FLAG_IS_NUMBER : 0);
+    rec.mode = static_cast<uint8_t>(p.mode);
+    rec.opId = p.opId;
+    rec.r1 = static_cast<int8_t>(p.r1);
+    rec.r2 = static_cast<int8_t>(p.r2);
+    rec.value = p.value;
+    rec.symId = p.symId;
+    rec.textOffset = stringBytes;
+    rec.labelLength = static_cast<uint16_t>(std::min<size_t>(line.label.size(), 0xFFFF));
+    rec.opcodeLength = static_cast<uint16_t>(std::min<size_t>(line.opcode.size(), 0xFFFF));
+    rec.operandLength = static_cast<uint32_t>(line.operand.size());
+    rec.lineNum = line.lineNum;
+
+    records.write(reinterpret_cast<const char*>(&rec), sizeof(rec));
+    strings.write(line.label.data(), rec.labelLength);
+    strings.write(line.opcode.data(), rec.opcodeLength);
+    strings.write(line.operand.data(), rec.operandLength);
+    stringBytes += rec.labelLength + rec.opcodeLength + rec.operandLength;
+    count++;
+}
+
+bool IntermediateWriter::finish(int startAddr, int programLength, const std::string& programName,
+                                const std::vector<int>& blockStarts, const SYMTAB& symtab,
+                                uint64_t optabDigest) {
+    // 블록 시작 주소 (뒤따르는 8바이트 정렬 구조를 위해 짝수 개로 채움)
+    std::vector<int32_t> starts(blockStarts.begin(), blockStarts.end());
+    uint32_t blockCount = static_cast<uint32_t>(starts.size());
+    if (starts.size() % 2 != 0) starts.push_back(0);
+    records.write(reinterpret_cast<const char*>(starts.data()), starts.size() * sizeof(int32_t));
+
+    // 심볼 이름 색인
+    for (int id = 0; id < symtab.size(); ++id) {
+        const std::string& name = symtab.nameOf(id);
+        IntermediateSymbolName entry;
+        entry.offset = stringBytes;
+        entry.length = static_cast<uint32_t>(name.size());
+        entry.reserved = 0;
+        records.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        strings.write(name.data(), name.size());
+        stringBytes += name.size();
+    }
+
+    IntermediateFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "INTB", 4);
+    header.version = FORMAT_VERSION;
+    header.count = count;
+    header.startAddr = startAddr;
+    header.programLength = programLength;
+    header.blockCount = blockCount;
+    header.symbolCount = static_cast<uint32_t>(symtab.size());
+    std::memcpy(header.name, programName.data(), std::min(programName.size(), sizeof(header.name)));
+    header.optabDigest = optabDigest;
+    records.seekp(0);
+    records.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    records.close();
+    strings.close();
+    if (!records || !strings) {
+        std::cerr << "Error: Failed to write intermediate file" << std::endl;
+        return false;
+    }
+    std::cout << "Intermediate records written: " << count << " ("
+              << count * sizeof(IntermediateRecord) + stringBytes << " bytes)" << std::endl;
+    return true;
+}
+
+uint64_t IntermediateWriter::size() const {
+    return count;
+}
+
+// ============================================================
+// IntermediateReader
+// ============================================================
+IntermediateReader::IntermediateReader()
+    : recordBase(nullptr), recordSize(0), stringBase(nullptr), stringSize(0), groupedBase(nullptr),
+      groupedSize(0), header(nullptr), records(nullptr), blockStarts(nullptr), symbolNames(nullptr) {}
+
+IntermediateReader::~IntermediateReader() {
+    close();
+}
+
+void IntermediateReader::close() {
+    if (recordBase != nullptr) munmap(const_cast<unsigned char*>(recordBase), recordSize);
+    if (stringBase != nullptr) munmap(const_cast<char*>(stringBase), stringSize);
+    if (groupedBase != nullptr) munmap(const_cast<unsigned char*>(groupedBase), groupedSize);
+    recordBase = nullptr;
+    stringBase = nullptr;
+    groupedBase = nullptr;
+    header = nullptr;
+}
+
+bool IntermediateReader::open(const std::string& recordFilename, const std::string& stringFilename,
+                              const OPTAB& optab) {
+    close();
+    const unsigned char* strBase = nullptr;
+    if (!mapFile(recordFilename, recordBase, recordSize) || !mapFile(stringFilename, strBase, stringSize)) {
+        close();
+        return false;
+    }
+    stringBase = reinterpret_cast<const char*>(strBase);
+
+    header = reinterpret_cast<const IntermediateFileHeader*>(recordBase);
+    bool valid = recordSize >= sizeof(IntermediateFileHeader) &&
+                 std::memcmp(header->magic, "INTB", 4) == 0 && header->version == FORMAT_VERSION &&
+                 header->count <= recordSize / sizeof(IntermediateRecord);
+    size_t blockSlots = valid ? (static_cast<size_t>(header->blockCount) + 1) / 2 * 2 : 0;
+    valid = valid &&
+            recordSize == sizeof(IntermediateFileHeader) +
+                              header->count * sizeof(IntermediateRecord) +
+                              blockSlots * sizeof(int32_t) +
+                              static_cast<size_t>(header->symbolCount) * sizeof(IntermediateSymbolName);
+    if (!valid) {
+        std::cerr << "Error: Invalid intermediate file: " << recordFilename << std::endl;
+        close();
+        return false;
+    }
+    // 레코드의 opcode ID는 쓴 프로세스의 OPTAB 기준
+    if (header->optabDigest != optab.digest()) {
+        std::cerr << "Error: Intermediate file was written with a different OPTAB: "
+                  << recordFilename << std::endl;
+        close();
+        return false;
+    }
+
+    records = reinterpret_cast<const IntermediateRecord*>(recordBase + sizeof(IntermediateFileHeader));
+    blockStarts = reinterpret_cast<const int32_t*>(records + header->count);
+    symbolNames = reinterpret_cast<const IntermediateSymbolName*>(blockStarts + blockSlots);
+
+    for (uint32_t k = 0; k < header->symbolCount; ++k) {
+        if (symbolNames[k].offset > stringSize ||
+            symbolNames[k].length > stringSize - symbolNames[k].offset) {
+            std::cerr << "Error: Corrupt intermediate file: " << stringFilename << std::endl;
+            close();
+            return false;
+        }
+    }
+
+    std::vector<uint64_t> blockCounts;
+    bool inOrder = true;
+    if (!validate(optab, blockCounts, inOrder)) {
+        std::cerr << "Error: Corrupt intermediate file: " << recordFilename << std::endl;
+        close();
+        return false;
+    }
+    if (!inOrder && !groupByBlock(recordFilename + ".grp", blockCounts)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// ============================================================
+// 레코드 검사: 문자열 범위, opcode/심볼/블록 ID, enum 값 (읽을 때는 다시 확인하지 않음)
+// 블록별 레코드 수와, 레코드가 이미 블록 시작 주소순으로 모여 있는지도 함께 구함
+// ============================================================
+bool IntermediateReader::validate(const OPTAB& optab, std::vector<uint64_t>& blockCounts,
+                                  bool& inOrder) const {
+    uint32_t blockCount = header->blockCount;
+    blockCounts.assign(blockCount, 0);
+    std::vector<uint32_t> rank(blockCount);
+    std::vector<uint32_t> order = blocksByStart(blockStarts, blockCount);
+    for (uint32_t r = 0; r < blockCount; ++r) {
+        rank[order[r]] = r;
+    }
+
+    inOrder = true;
+    uint32_t lastRank = 0;
+    for (uint64_t k = 0; k < header->count; ++k) {
+        if (k % RELEASE_INTERVAL == 0) {
+            release(k);
+        }
+        const IntermediateRecord& rec = records[k];
+        uint64_t textLength = static_cast<uint64_t>(rec.labelLength) + rec.opcodeLength + rec.operandLength;
+        if (rec.textOffset > stringSize || textLength > stringSize - rec.textOffset ||
+            rec.opId < -1 || rec.opId >= optab.size() ||
+            rec.block < 0 || static_cast<uint32_t>(rec.block) >= blockCount ||
+            rec.symId < -1 || (rec.symId >= 0 && static_cast<uint32_t>(rec.symId) >= header->symbolCount) ||
+            rec.directive > static_cast<uint8_t>(Directive::FILL) ||
+            rec.mode > static_cast<uint8_t>(AddrMode::INDIRECT)) {
+            std::cerr << "Error: Invalid intermediate record " << k << " (line " << rec.lineNum << ")"
+                      << std::endl;
+            return false;
+        }
+        blockCounts[rec.block]++;
+        if (rank[rec.block] < lastRank) inOrder = false;
+        lastRank = std::max(lastRank, rank[rec.block]);
+    }
+    release(header->count);
+    return true;
+}
+
+// ============================================================
+// 블록이 섞인 레코드를 블록 시작 주소순으로 한 번만 재배열 (계수 정렬)
+// 블록마다 GROUP_BATCH개씩 모았다가 그 블록 자리에 써서 메모리는 블록 수에만 비례
+// ============================================================
+bool IntermediateReader::groupByBlock(const std::string& spillFilename,
+                                      const std::vector<uint64_t>& blockCounts) {
+    std::vector<uint64_t> next(blockCounts.size());
+    uint64_t slot = 0;
+    for (uint32_t b : blocksByStart(blockStarts, header->blockCount)) {
+        next[b] = slot;
+        slot += blockCounts[b];
+    }
+
+    int fd = ::open(spillFilename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot write intermediate file: " << spillFilename << std::endl;
+        return false;
+    }
+    std::vector<std::vector<IntermediateRecord>> pending(blockCounts.size());
+    auto flush = [&](size_t block) {
+        std::vector<IntermediateRecord>& batch = pending[block];
+        bool ok = batch.empty() ||
+                  writeAt(fd, batch.data(), batch.size() * sizeof(IntermediateRecord),
+                          static_cast<off_t>(next[block] * sizeof(IntermediateRecord)));
+        next[block] += batch.size();
+        batch.clear();
+        return ok;
+    };
+    bool ok = true;
+    for (uint64_t k = 0; k < header->count && ok; ++k) {
+        if (k % RELEASE_INTERVAL == 0) {
+            release(k);
+        }
+        std::vector<IntermediateRecord>& batch = pending[records[k].block];
+        if (batch.empty()) batch.reserve(GROUP_BATCH);
+        batch.push_back(records[k]);
+        if (batch.size() == GROUP_BATCH) ok = flush(records[k].block);
+    }
+    for (size_t b = 0; b < pending.size() && ok; ++b) {
+        ok = flush(b);
+    }
+    release(header->count);
+    ::close(fd);
+
+    // 매핑한 뒤 바로 지워도 매핑이 살아 있는 동안 내용은 남음
+    const unsigned char* base = nullptr;
+    size_t size = 0;
+    ok = ok && mapFile(spillFilename, base, size) &&
+         size == header->count * sizeof(IntermediateRecord);
+    ::unlink(spillFilename.c_str());
+    if (!ok) {
+        std::cerr << "Error: Failed to group intermediate records by block" << std::endl;
+        if (base != nullptr) munmap(const_cast<unsigned char*>(base), size);
+        return false;
+    }
+    groupedBase = base;
+    groupedSize = size;
+    records = reinterpret_cast<const IntermediateRecord*>(groupedBase);
+    return true;
+}
+
+void IntermediateReader::bindSymbols(SYMTAB& symtab) {
+    symbolMap.assign(header != nullptr ? header->symbolCount : 0, -1);
+    for (size_t k = 0; k < symbolMap.size(); ++k) {
+        symbolMap[k] = symtab.intern(std::string(stringBase + symbolNames[k].offset, symbolNames[k].length));
+    }
+}
+
+uint64_t IntermediateReader::size() const {
+    return header != nullptr ? header->count : 0;
+}
+
+int IntermediateReader::getStartAddress() const {
+    return header->startAddr;
+}
+
+int IntermediateReader::getProgramLength() const {
+    return header->programLength;
+}
+
+std::string IntermediateReader::getProgramName() const {
+    return std::string(header->name, strnlen(header->name, sizeof(header->name)));
+}
+
+int IntermediateReader::getBlockCount() const {
+    return static_cast<int>(header->blockCount);
+}
+
+int IntermediateReader::getBlockStart(int block) const {
+    return blockStarts[block];
+}
+
+void IntermediateReader::read(uint64_t index, IntermediateLine& line) const {
+    const IntermediateRecord& rec = records[index];
+    line.hasLocation = (rec.flags & IntermediateRecord::FLAG_HAS_LOCATION) != 0;
+    line.block = rec.block;
+    line.location = rec.location;
+    if (line.hasLocation) {
+        line.location += blockStarts[rec.block];
+    }
+    line.length = rec.length;
+    line.lineNum = rec.lineNum;
+    line.directive = static_cast<Directive>(rec.directive);
+
+    const char* text = stringBase + rec.textOffset;
+    line.label.assign(text, rec.labelLength);
+    line.opcode.assign(text + rec.labelLength, rec.opcodeLength);
+    line.operand.assign(text + rec.labelLength + rec.opcodeLength, rec.operandLength);
+    line.objcode.clear();
+
+    ParsedOperand& p = line.parsed;
+    p.mode = static_cast<AddrMode>(rec.mode);
+    p.indexed = (rec.flags & IntermediateRecord::FLAG_INDEXED) != 0;
+    p.extended = (rec.flags & IntermediateRecord::FLAG_EXTENDED) != 0;
+    p.isNumber = (rec.flags & IntermediateRecord::FLAG_IS_NUMBER) != 0;
+    p.opId = rec.opId;
+    p.r1 = rec.r1;
+    p.r2 = rec.r2;
+    p.value = rec.value;
+    p.symId = rec.symId >= 0 ? symbolMap[rec.symId] : -1;
+}
+
+void IntermediateReader::release(uint64_t index) const {
+    if (header == nullptr || index == 0) return;
+    if (index > header->count) index = header->count;
+    dropPages(records, index * sizeof(IntermediateRecord));
+    // 재배열한 레코드는 문자열 위치가 증가하지 않으므로 문자열 페이지는 그대로 둠
+    if (stringBase != nullptr && groupedBase == nullptr && index < header->count) {
+        dropPages(stringBase, records[index].textOffset);
+    }
+}
@@ -0,0 +1,196 @@
+#include "../include/assembler.h"
+#include <cstring>
+
+namespace {
+
+void writeUleb(std::vector<uint8_t>& out, uint32_t value) {
+    do {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        if (value != 0) byte |= 0x80;
+        out.push_back(byte);
+    } while (value != 0);
+}
+
+void writeSleb(std::vector<uint8_t>& out, int32_t value) {
+    bool more = true;
+    while (more) {
+        uint8_t byte = value & 0x7F;
+        value >>= 7;  // 산술 시프트
+        if ((value == 0 && (byte & 0x40) == 0) || (value == -1 && (byte & 0x40) != 0)) {
+            more = false;
+        } else {
+            byte |= 0x80;
+        }
+        out.push_back(byte);
+    }
+}
+
+uint32_t readUleb(const uint8_t* data, size_t& pos) {
+    uint32_t result = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+        byte = data[pos++];
+        result |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return result;
+}
+
+int32_t readSleb(const uint8_t* data, size_t& pos) {
+    int32_t result = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+        byte = data[pos++];
+        result |= static_cast<int32_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    if (shift < 32 && (byte & 0x40)) {
+        result |= -(static_cast<int32_t>(1) << shift);  // 부호 확장
+    }
+    return result;
+}
+
+}  // namespace
+
+LineMap::LineMap() : rowCount(0), lastAddress(0), lastLine(0), endAddress(-1) {}
+
+void LineMap::setSourceFile(const std::string& filename) {
+    sourceFile = filename;
+}
+
+const std::string& LineMap::getSourceFile() const {
+    return sourceFile;
+}
+
+// 체크포인트 행은 절대값만 두고, 나머지 행은 직전 행과의 차이로 기록
+void LineMap::appendRow(int address, int line) {
+    if (rowCount % CHECKPOINT_INTERVAL == 0) {
+        checkpoints.push_back({static_cast<uint32_t>(address), static_cast<uint32_t>(line),
+                               static_cast<uint32_t>(encoded.size())});
+    } else {
+        writeUleb(encoded, static_cast<uint32_t>(address - lastAddress));
+        writeSleb(encoded, line - lastLine);
+    }
+    lastAddress = address;
+    lastLine = line;
+    rowCount++;
+}
+
+void LineMap::add(int address, int length, int lineNum) {
+    if (length <= 0) return;
+    if (endAddress >= 0 && address > endAddress) {
+        appendRow(endAddress, 0);  // 빈 구간
+    }
+    // 이어지는 같은 라인은 행 하나로 합침 (BYTE가 여러 레코드에 걸친 경우 등)
+    if (rowCount == 0 || address != endAddress || lineNum != lastLine) {
+        appendRow(address, lineNum);
+    }
+    endAddress = address + length;
+}
+
+void LineMap::finish() {
+    if (endAddress >= 0) {
+        appendRow(endAddress, 0);  // 마지막 구간의 끝
+        endAddress = -1;
+    }
+}
+
+// ============================================================
+// 조회: 체크포인트 이진 탐색 후 다음 체크포인트 전까지 차이를 풀어 감
+// ============================================================
+int LineMap::lookup(int address) const {
+    if (checkpoints.empty() || address < static_cast<int>(checkpoints[0].address)) {
+        return 0;
+    }
+    uint32_t target = static_cast<uint32_t>(address);
+    auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), target,
+                               [](uint32_t addr, const Checkpoint& cp) { return addr < cp.address; });
+    --it;
+
+    uint32_t currentAddress = it->address;
+    int32_t currentLine = static_cast<int32_t>(it->line);
+    size_t pos = it->offset;
+    size_t end = (it + 1 != checkpoints.end()) ? (it + 1)->offset : encoded.size();
+    while (pos < end) {
+        uint32_t nextAddress = currentAddress + readUleb(encoded.data(), pos);
+        if (nextAddress > target) {
+            break;
+        }
+        currentAddress = nextAddress;
+        currentLine += readSleb(encoded.data(), pos);
+    }
+    return currentLine;
+}
+
+size_t LineMap::getRowCount() const {
+    return rowCount;
+}
+
+size_t LineMap::getEncodedSize() const {
+    return encoded.size() + checkpoints.size() * sizeof(Checkpoint);
+}
+
+// ============================================================
+// 파일 입출력: [헤더][소스 파일 이름][체크포인트][압축된 행]
+// ============================================================
+bool LineMap::writeToFile(const std::string& filename) const {
+    TRACE_SPAN("write LINEMAP");
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot write line map: " << filename << std::endl;
+        return false;
+    }
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "LMAP", 4);
+    header.version = 1;
+    header.rowCount = rowCount;
+    header.checkpointCount = static_cast<uint32_t>(checkpoints.size());
+    header.encodedBytes = static_cast<uint32_t>(encoded.size());
+    header.fileNameLength = static_cast<uint32_t>(sourceFile.size());
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(sourceFile.data(), sourceFile.size());
+    file.write(reinterpret_cast<const char*>(checkpoints.data()), checkpoints.size() * sizeof(Checkpoint));
+    file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+    file.close();
+    std::cout << "Line map written: " << filename << " (" << rowCount << " rows, "
+              << sizeof(header) + sourceFile.size() + getEncodedSize() << " bytes)" << std::endl;
+    return true;
+}
+
+bool LineMap::loadFromFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open line map: " << filename << std::endl;
+        return false;
+    }
+    FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, "LMAP", 4) != 0 || header.version != 1) {
+        std::cerr << "Error: Invalid line map: " << filename << std::endl;
+        return false;
+    }
+    sourceFile.assign(header.fileNameLength, '\0');
+    checkpoints.resize(header.checkpointCount);
+    encoded.resize(header.encodedBytes);
+    file.read(&sourceFile[0], sourceFile.size());
+    file.read(reinterpret_cast<char*>(checkpoints.data()), checkpoints.size() * sizeof(Checkpoint));
+    file.read(reinterpret_cast<char*>(encoded.data()), encoded.size());
+    if (!file) {
+        std::cerr << "Error: Truncated line map: " << filename << std::endl;
+        return false;
+    }
+    for (const auto& cp : checkpoints) {
+        if (cp.offset > encoded.size()) {
+            std::cerr << "Error: Corrupt line map: " << filename << std::endl;
+            return false;
+        }
+    }
+    rowCount = header.rowCount;
+    endAddress = -1;
+    return true;
+}
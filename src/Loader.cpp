@@ -0,0 +1,252 @@
+#include "../include/assembler.h"
+
+namespace {
+
+// 16진수 한 글자 -> 값 (잘못된 글자는 -1)
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool parseHexField(const std::string& line, size_t pos, size_t len, int& value) {
+    if (pos + len > line.size()) return false;
+    value = 0;
+    for (size_t k = pos; k < pos + len; ++k) {
+        int d = hexDigit(line[k]);
+        if (d < 0) return false;
+        value = (value << 4) | d;
+    }
+    return true;
+}
+
+}  // namespace
+
+Loader::Loader(int memorySize) : memory(memorySize, 0), entryPoint(0), programLength(0) {}
+
+// ============================================================
+// 재배치 적재: H/T 레코드로 메모리를 채운 뒤 M 레코드를 일괄 적용
+// ============================================================
+bool Loader::load(const std::string& objFilename, int loadAddr) {
+    std::ifstream file(objFilename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open object file: " << objFilename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNum = 0;
+    int startAddr = 0;
+    bool hasHeader = false;
+    std::vector<ModRecord> mods;
+
+    while (std::getline(file, line)) {
+        lineNum++;
+        if (line.empty()) continue;
+
+        switch (line[0]) {
+        case 'H':
+            // H[이름(6)][시작 주소(6)][길이(6)]
+            if (!parseHexField(line, 7, 6, startAddr) || !parseHexField(line, 13, 6, programLength)) {
+                std::cerr << "Error at line " << lineNum << ": Invalid H record" << std::endl;
+                return false;
+            }
+            if (loadAddr < 0 || loadAddr + programLength > static_cast<int>(memory.size())) {
+                std::cerr << "Error: Program does not fit at 0x" << std::hex << loadAddr
+                          << std::dec << std::endl;
+                return false;
+            }
+            hasHeader = true;
+            break;
+
+        case 'T': {
+            // T[시작 주소(6)][길이(2)][코드...]
+            int addr = 0, length = 0;
+            if (!hasHeader || !parseHexField(line, 1, 6, addr) || !parseHexField(line, 7, 2, length) ||
+                line.size() < 9 + static_cast<size_t>(length) * 2) {
+                std::cerr << "Error at line " << lineNum << ": Invalid T record" << std::endl;
+                return false;
+            }
+            int offset = addr - startAddr;
+            if (offset < 0 || offset + length > programLength) {
+                std::cerr << "Error at line " << lineNum << ": T record outside program" << std::endl;
+                return false;
+            }
+            unsigned char* dst = &memory[loadAddr + offset];
+            for (int k = 0; k < length; ++k) {
+                int hi = hexDigit(line[9 + k * 2]);
+                int lo = hexDigit(line[10 + k * 2]);
+                if (hi < 0 || lo < 0) {
+                    std::cerr << "Error at line " << lineNum << ": Invalid hex in T record" << std::endl;
+                    return false;
+                }
+                dst[k] = static_cast<unsigned char>((hi << 4) | lo);
+            }
+            break;
+        }
+
+        case 'F': {
+            // F[시작 주소(6)][반복 수(6)][패턴 길이(2)][패턴...]: 패턴을 한 번 풀고 두 배씩 복사
+            int addr = 0, count = 0, patternLength = 0;
+            if (!hasHeader || !parseHexField(line, 1, 6, addr) || !parseHexField(line, 7, 6, count) ||
+                !parseHexField(line, 13, 2, patternLength) || patternLength == 0 ||
+                line.size() < 15 + static_cast<size_t>(patternLength) * 2) {
+                std::cerr << "Error at line " << lineNum << ": Invalid F record" << std::endl;
+                return false;
+            }
+            int offset = addr - startAddr;
+            long long length = static_cast<long long>(count) * patternLength;
+            if (offset < 0 || offset + length > programLength) {
+                std::cerr << "Error at line " << lineNum << ": F record outside program" << std::endl;
+                return false;
+            }
+            if (length == 0) break;
+            unsigned char* dst = &memory[loadAddr + offset];
+            unsigned char* end = dst + length;
+            for (int k = 0; k < patternLength && dst + k < end; ++k) {
+                int hi = hexDigit(line[15 + k * 2]);
+                int lo = hexDigit(line[16 + k * 2]);
+                if (hi < 0 || lo < 0) {
+                    std::cerr << "Error at line " << lineNum << ": Invalid hex in F record" << std::endl;
+                    return false;
+                }
+                dst[k] = static_cast<unsigned char>((hi << 4) | lo);
+            }
+            if (patternLength == 1) {
+                std::fill(dst + 1, end, dst[0]);
+            } else {
+                for (long long filled = patternLength; filled < length;) {
+                    long long chunk = std::min(filled, length - filled);
+                    std::copy(dst, dst + chunk, dst + filled);
+                    filled += chunk;
+                }
+            }
+            break;
+        }
+
+        case 'M': {
+            // M[시작 기준 주소(6)][길이(2)]
+            ModRecord mod;
+            if (!parseHexField(line, 1, 6, mod.offset) || !parseHexField(line, 7, 2, mod.halfBytes) ||
+                mod.halfBytes < 1 || mod.halfBytes > 6) {
+                std::cerr << "Error at line " << lineNum << ": Invalid M record" << std::endl;
+                return false;
+            }
+            mods.push_back(mod);
+            break;
+        }
+
+        case 'E': {
+            int addr = startAddr;
+            if (line.size() > 1 && !parseHexField(line, 1, 6, addr)) {
+                std::cerr << "Error at line " << lineNum << ": Invalid E record" << std::endl;
+                return false;
+            }
+            entryPoint = loadAddr + (addr - startAddr);
+            break;
+        }
+
+        default:
+            std::cerr << "Warning at line " << lineNum << ": Unknown record type " << line[0] << std::endl;
+            break;
+        }
+    }
+    file.close();
+
+    if (!hasHeader) {
+        std::cerr << "Error: Missing H record in " << objFilename << std::endl;
+        return false;
+    }
+
+    if (!applyModifications(mods, loadAddr, programLength, loadAddr - startAddr)) {
+        return false;
+    }
+
+    std::cout << "Loaded " << objFilename << " at 0x" << std::hex << std::uppercase << loadAddr
+              << " (" << std::dec << mods.size() << " relocations)" << std::endl;
+    return true;
+}
+
+// M 레코드를 주소순으로 정렬한 뒤 페이지 단위로 묶어서 적용
+// (범위 검사는 페이지마다 한 번, 페이지 안에서는 연속된 메모리만 접근)
+bool Loader::applyModifications(std::vector<ModRecord>& mods, int base, int length, int delta) {
+    if (mods.empty() || delta == 0) return true;
+
+    std::sort(mods.begin(), mods.end(),
+              [](const ModRecord& a, const ModRecord& b) { return a.offset < b.offset; });
+
+    size_t k = 0;
+    while (k < mods.size()) {
+        int page = mods[k].offset / PAGE_SIZE;
+        size_t pageEnd = k;
+        int lastByte = 0;
+        while (pageEnd < mods.size() && mods[pageEnd].offset / PAGE_SIZE == page) {
+            lastByte = std::max(lastByte, mods[pageEnd].offset + (mods[pageEnd].halfBytes + 1) / 2);
+            ++pageEnd;
+        }
+        if (mods[k].offset < 0 || lastByte > length) {
+            std::cerr << "Error: M record outside program at offset 0x" << std::hex
+                      << mods[k].offset << std::dec << std::endl;
+            return false;
+        }
+
+        unsigned char* pageBase = &memory[base];
+        for (; k < pageEnd; ++k) {
+            const ModRecord& mod = mods[k];
+            int bytes = (mod.halfBytes + 1) / 2;
+            unsigned char* field = pageBase + mod.offset;
+
+            // 필드를 big-endian 정수로 읽고 half-byte 길이만큼 마스킹
+            unsigned int value = 0;
+            for (int b = 0; b < bytes; ++b) {
+                value = (value << 8) | field[b];
+            }
+            unsigned int mask = (1u << (mod.halfBytes * 4)) - 1;
+            long long patched = static_cast<long long>(value & mask) + delta;
+            if (patched < 0 || patched > mask) {
+                std::cerr << "Error: Relocated value does not fit in " << mod.halfBytes
+                          << " half-bytes at offset 0x" << std::hex << mod.offset << std::dec
+                          << std::endl;
+                return false;
+            }
+            value = (value & ~mask) | static_cast<unsigned int>(patched);
+
+            for (int b = bytes - 1; b >= 0; --b) {
+                field[b] = static_cast<unsigned char>(value & 0xFF);
+                value >>= 8;
+            }
+        }
+    }
+    return true;
+}
+
+int Loader::getEntryPoint() const {
+    return entryPoint;
+}
+
+int Loader::getProgramLength() const {
+    return programLength;
+}
+
+const std::vector<unsigned char>& Loader::getMemory() const {
+    return memory;
+}
+
+void Loader::dumpMemory(int address, int length) const {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "MEMORY DUMP" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+
+    int end = std::min(address + length, static_cast<int>(memory.size()));
+    for (int row = address; row < end; row += 16) {
+        std::cout << std::right << std::hex << std::uppercase << std::setfill('0')
+                  << std::setw(6) << row << "  ";
+        for (int k = row; k < std::min(row + 16, end); ++k) {
+            std::cout << std::setw(2) << static_cast<int>(memory[k]);
+            if ((k - row) % 4 == 3) std::cout << ' ';
+        }
+        std::cout << std::dec << std::left << std::setfill(' ') << std::endl;
+    }
+    std::cout << std::string(60, '=') << std::endl;
+}
@@ -41,9 +41,21 @@ bool OPTAB::load(const std::string& filename) {
         
         if (iss >> mnemonic >> opcode) {
             InstructionInfo info;
+            info.mnemonic = mnemonic;
             info.opcode = opcode;
+            if (!Parser::parseNumber(opcode, info.opcodeValue, 16)) {
+                std::cerr << "Error at line " << lineNum << ": Invalid opcode " << opcode << std::endl;
+                continue;
+            }
             info.format = determineFormat(mnemonic);
-            table[mnemonic] = info;
+
+            auto it = table.find(mnemonic);
+            if (it != table.end()) {
+                entries[it->second] = info;
+            } else {
+                table[mnemonic] = static_cast<int>(entries.size());
+                entries.push_back(info);
+            }
         }
     }
     
@@ -59,7 +71,7 @@ bool OPTAB::isInstruction(const std::string& mnemonic) const {
 std::string OPTAB::getOpcode(const std::string& mnemonic) const {
     auto it = table.find(mnemonic);
     if (it != table.end()) {
-        return it->second.opcode;
+        return entries[it->second].opcode;
     }
     return "";
 }
@@ -67,11 +79,46 @@ std::string OPTAB::getOpcode(const std::string& mnemonic) const {
 int OPTAB::getFormat(const std::string& mnemonic) const {
     auto it = table.find(mnemonic);
     if (it != table.end()) {
-        return it->second.format;
+        return entries[it->second].format;
     }
     return 0;
 }
 
+int OPTAB::getId(const std::string& mnemonic) const {
+    auto it = table.find(mnemonic);
+    if (it != table.end()) {
+        return it->second;
+    }
+    return -1;
+}
+
+const InstructionInfo& OPTAB::getInfo(int id) const {
+    return entries[id];
+}
+
+int OPTAB::size() const {
+    return static_cast<int>(entries.size());
+}
+
+// ID 순서의 니모닉/opcode/형식에 대한 64비트 FNV-1a (ID가 같은 OPTAB인지 확인용)
+uint64_t OPTAB::digest() const {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t k = 0; k < size; ++k) {
+            hash = (hash ^ bytes[k]) * 0x100000001B3ULL;
+        }
+    };
+    for (const auto& info : entries) {
+        uint32_t length = static_cast<uint32_t>(info.mnemonic.size());
+        int32_t fields[2] = {info.opcodeValue, info.format};
+        mix(&length, sizeof(length));
+        mix(info.mnemonic.data(), info.mnemonic.size());
+        mix(fields, sizeof(fields));
+    }
+    return hash;
+}
+
 void OPTAB::printTable() const {
     std::cout << "\n" << std::string(60, '=') << std::endl;
     std::cout << "OPERATION CODE TABLE (OPTAB)" << std::endl;
@@ -82,9 +129,10 @@ void OPTAB::printTable() const {
     std::cout << std::string(60, '-') << std::endl;
     
     for (const auto& entry : table) {
+        const InstructionInfo& info = entries[entry.second];
         std::cout << std::left << std::setw(15) << entry.first 
-                  << std::setw(10) << entry.second.opcode
-                  << "Format " << entry.second.format << std::endl;
+                  << std::setw(10) << info.opcode
+                  << "Format " << info.format << std::endl;
     }
     std::cout << std::string(60, '=') << std::endl;
 }
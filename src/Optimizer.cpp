@@ -0,0 +1,317 @@
+#include "../include/assembler.h"
+
+namespace {
+
+// 같은 레지스터의 저장 -> 적재 쌍
+const char* STORE_LOAD_PAIRS[][2] = {
+    {"STA", "LDA"}, {"STX", "LDX"}, {"STL", "LDL"}, {"STB", "LDB"},
+    {"STS", "LDS"}, {"STT", "LDT"}, {"STF", "LDF"}, {"STCH", "LDCH"},
+};
+
+// LDr #0 -> CLEAR r
+const char* CLEAR_LOADS[][2] = {
+    {"LDA", "A"}, {"LDX", "X"}, {"LDL", "L"}, {"LDB", "B"}, {"LDS", "S"}, {"LDT", "T"},
+};
+
+const char* JUMPS[] = {"J", "JEQ", "JGT", "JLT", "JSUB"};
+
+std::string mnemonicOf(const std::string& opcode) {
+    return (!opcode.empty() && opcode[0] == '+') ? opcode.substr(1) : opcode;
+}
+
+std::string textOf(const IntermediateLine& line) {
+    return line.operand.empty() ? line.opcode : line.opcode + " " + line.operand;
+}
+
+bool sameOperand(const ParsedOperand& a, const ParsedOperand& b) {
+    return a.mode == b.mode && a.indexed == b.indexed && a.isNumber == b.isNumber &&
+           (a.isNumber ? a.value == b.value : a.symId == b.symId);
+}
+
+// Format 3의 재배치 심볼 피연산자가 PC-relative 범위 안인지 (Pass2의 E204/E205 조건)
+bool fitsPcRelative(const IntermediateLine& line, const SYMTAB* symtab) {
+    const ParsedOperand& p = line.parsed;
+    if (p.opId < 0 || p.extended || p.mode == AddrMode::NONE || p.isNumber ||
+        !symtab->isRelative(p.symId)) {
+        return true;
+    }
+    int disp = symtab->addressOf(p.symId) - (line.location + line.length);
+    return disp >= -2048 && disp <= 2047;
+}
+
+}  // namespace
+
+Optimizer::Optimizer(OPTAB* opt, SYMTAB* sym, Pass1* p1)
+    : optab(opt), symtab(sym), pass1(p1), lengthBefore(0), lengthAfter(0) {}
+
+void Optimizer::record(const std::string& rule, const IntermediateLine& line,
+                       const std::string& after, int bytesSaved) {
+    changes.push_back({rule, line.location, textOf(line), after, bytesSaved});
+}
+
+// ============================================================
+// 최적화 실행 (주소가 바뀌면 매번 다시 배정)
+// ============================================================
+void Optimizer::run() {
+    std::cout << "\n[Optimizer] Running peephole optimizer..." << std::endl;
+    std::vector<IntermediateLine>& lines = pass1->getIntFile();
+    lengthBefore = pass1->getProgramLength();
+
+    std::vector<JumpRetarget> retargets;
+    int changed = removeRedundantLoads(lines) + useClear(lines) + collapseJumpChains(lines, retargets);
+    if (changed > 0) {
+        pass1->relayout();
+    }
+    fitJumpChains(lines, retargets);
+
+    // Format 4 축소는 주소가 줄어들수록 더 가능해지므로 더 이상 바뀌지 않을 때까지 반복
+    while (shrinkExtended(lines) > 0) {
+        pass1->relayout();
+    }
+
+    lengthAfter = pass1->getProgramLength();
+    std::cout << "Optimizer completed: " << changes.size() << " changes, "
+              << lengthBefore - lengthAfter << " bytes saved" << std::endl;
+}
+
+// STx m 바로 다음의 LDx m (라벨 없음)은 레지스터 값이 이미 같으므로 삭제
+int Optimizer::removeRedundantLoads(std::vector<IntermediateLine>& lines) {
+    std::vector<std::pair<int, int>> pairs;
+    for (const auto& names : STORE_LOAD_PAIRS) {
+        pairs.emplace_back(optab->getId(names[0]), optab->getId(names[1]));
+    }
+
+    int count = 0;
+    std::vector<IntermediateLine> kept;
+    kept.reserve(lines.size());
+    for (size_t k = 0; k < lines.size(); ++k) {
+        const IntermediateLine& line = lines[k];
+        bool redundant = false;
+        if (!kept.empty() && line.label.empty() && line.parsed.opId >= 0 &&
+            line.parsed.mode != AddrMode::IMMEDIATE && line.parsed.mode != AddrMode::NONE) {
+            const IntermediateLine& prev = kept.back();
+            for (const auto& pair : pairs) {
+                if (prev.parsed.opId == pair.first && line.parsed.opId == pair.second &&
+                    prev.block == line.block && sameOperand(prev.parsed, line.parsed)) {
+                    redundant = true;
+                    break;
+                }
+            }
+        }
+        if (redundant) {
+            record("redundant load", line, "", line.length);
+            count++;
+        } else {
+            kept.push_back(line);
+        }
+    }
+    lines.swap(kept);
+    return count;
+}
+
+// LDr #0 -> CLEAR r (Format 2, 조건 코드는 둘 다 바꾸지 않음)
+// COMP #0은 0을 담은 레지스터가 보장되지 않으므로 더 싼 SIC/XE 형태가 없음
+int Optimizer::useClear(std::vector<IntermediateLine>& lines) {
+    int clearId = optab->getId("CLEAR");
+    if (clearId < 0) return 0;
+
+    int count = 0;
+    for (auto& line : lines) {
+        const ParsedOperand& p = line.parsed;
+        if (p.opId < 0 || p.mode != AddrMode::IMMEDIATE || !p.isNumber || p.value != 0 || p.indexed) {
+            continue;
+        }
+        std::string mnemonic = mnemonicOf(line.opcode);
+        for (const auto& load : CLEAR_LOADS) {
+            if (mnemonic != load[0]) continue;
+            std::string after = std::string("CLEAR ") + load[1];
+            record("load zero", line, after, line.length - 2);
+
+            ParsedOperand clear;
+            clear.opId = clearId;
+            clear.r1 = Parser::registerNumber(load[1]);
+            line.parsed = clear;
+            line.opcode = "CLEAR";
+            line.operand = load[1];
+            line.length = 2;
+            count++;
+            break;
+        }
+    }
+    return count;
+}
+
+// J a, a: J b  ->  J b (조건 점프, JSUB의 대상도 따라감, 순환은 중단)
+// 새 대상까지의 거리는 주소 재배정 후에 fitJumpChains가 확인하고 기록
+int Optimizer::collapseJumpChains(std::vector<IntermediateLine>& lines,
+                                  std::vector<JumpRetarget>& retargets) {
+    std::vector<int> jumpIds;
+    for (const char* name : JUMPS) {
+        jumpIds.push_back(optab->getId(name));
+    }
+    int jId = optab->getId("J");
+
+    // 라벨 심볼 -> 그 라벨이 붙은 무조건 점프의 대상 심볼
+    std::map<int, int> forward;
+    for (const auto& line : lines) {
+        const ParsedOperand& p = line.parsed;
+        if (!line.label.empty() && p.opId == jId && p.opId >= 0 && p.mode == AddrMode::SIMPLE &&
+            !p.indexed && !p.isNumber && p.symId >= 0) {
+            forward.emplace(symtab->intern(line.label), p.symId);
+        }
+    }
+
+    int count = 0;
+    for (size_t k = 0; k < lines.size(); ++k) {
+        IntermediateLine& line = lines[k];
+        ParsedOperand& p = line.parsed;
+        if (p.opId < 0 || p.mode != AddrMode::SIMPLE || p.indexed || p.isNumber || p.symId < 0 ||
+            std::find(jumpIds.begin(), jumpIds.end(), p.opId) == jumpIds.end()) {
+            continue;
+        }
+        int target = p.symId;
+        std::vector<int> visited{target};
+        auto it = forward.find(target);
+        while (it != forward.end() &&
+               std::find(visited.begin(), visited.end(), it->second) == visited.end()) {
+            target = it->second;
+            visited.push_back(target);
+            it = forward.find(target);
+        }
+        if (target == p.symId || it != forward.end()) {
+            continue;  // 체인이 없거나 순환
+        }
+        retargets.push_back({k, line.location, textOf(line), p.symId, line.operand});
+        p.symId = target;
+        line.operand = symtab->nameOf(target);
+        count++;
+    }
+    return count;
+}
+
+// 체인의 끝이 PC-relative 범위 밖이면 +op로 바꾸고 다시 배정
+// +op로 늘어난 만큼 다른 Format 3 피연산자가 범위를 벗어나면 늘린 점프를 모두 원래 대상으로 되돌림
+// (되돌리면 길이가 최적화 전보다 길지 않으므로 원래 범위 안이던 피연산자는 다시 범위 안)
+void Optimizer::fitJumpChains(std::vector<IntermediateLine>& lines,
+                              const std::vector<JumpRetarget>& retargets) {
+    if (retargets.empty()) return;
+    std::vector<bool> fitted(lines.size());
+    for (size_t k = 0; k < lines.size(); ++k) {
+        fitted[k] = fitsPcRelative(lines[k], symtab);
+    }
+    std::vector<bool> isRetarget(lines.size(), false);
+    for (const auto& r : retargets) {
+        isRetarget[r.line] = true;
+    }
+
+    // 늘어날 때마다 다른 체인 점프도 밀려날 수 있으므로 더 늘릴 것이 없을 때까지 반복
+    std::vector<bool> grown(lines.size(), false);
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (const auto& r : retargets) {
+            IntermediateLine& line = lines[r.line];
+            if (line.parsed.extended || fitsPcRelative(line, symtab)) continue;
+            line.parsed.extended = true;
+            line.opcode = "+" + line.opcode;
+            line.length = 4;
+            grown[r.line] = true;
+            changed = true;
+        }
+        if (changed) pass1->relayout();
+    }
+
+    bool overflow = false;
+    for (size_t k = 0; k < lines.size() && !overflow; ++k) {
+        overflow = fitted[k] && !isRetarget[k] && !fitsPcRelative(lines[k], symtab);
+    }
+    if (overflow) {
+        for (const auto& r : retargets) {
+            if (!grown[r.line]) continue;
+            IntermediateLine& line = lines[r.line];
+            line.parsed.extended = false;
+            line.parsed.symId = r.originalSym;
+            line.opcode = mnemonicOf(line.opcode);
+            line.operand = r.originalOperand;
+            line.length = 3;
+        }
+        pass1->relayout();
+    }
+
+    for (const auto& r : retargets) {
+        const IntermediateLine& line = lines[r.line];
+        if (overflow && grown[r.line]) {
+            std::ostringstream note;
+            note << "0x" << std::hex << std::uppercase << std::setfill('0') << std::setw(6)
+                 << r.location << "  jump chain skipped: " << r.before
+                 << " (target too far, +op would push other operands out of range)";
+            notes.push_back(note.str());
+            continue;
+        }
+        changes.push_back({"jump chain", r.location, r.before, textOf(line), grown[r.line] ? -1 : 0});
+    }
+}
+
+// 주소가 확정된 뒤 Format 3로 충분한 +op를 축소
+// (재배치 심볼은 PC-relative 범위 안일 때만, 숫자와 절대 심볼은 12비트 안일 때만)
+int Optimizer::shrinkExtended(std::vector<IntermediateLine>& lines) {
+    int count = 0;
+    for (auto& line : lines) {
+        ParsedOperand& p = line.parsed;
+        if (p.opId < 0 || !p.extended) continue;
+
+        bool fits = false;
+        if (p.mode == AddrMode::NONE) {
+            fits = true;
+        } else if (p.isNumber) {
+            fits = p.value >= 0 && p.value <= 0xFFF;
+        } else if (p.symId >= 0 && symtab->isDefined(p.symId)) {
+            int target = symtab->addressOf(p.symId);
+            if (symtab->isRelative(p.symId)) {
+                int disp = target - (line.location + 3);
+                fits = disp >= -2048 && disp <= 2047;  // #label도 PC-relative로 담김
+            } else {
+                // 절대 심볼은 즉시값일 때만 (주소 모드면 Pass2가 PC-relative를 먼저 시도함)
+                fits = p.mode == AddrMode::IMMEDIATE && target >= 0 && target <= 0xFFF;
+            }
+        }
+        if (!fits) continue;
+
+        std::string after = mnemonicOf(line.opcode);
+        if (!line.operand.empty()) after += " " + line.operand;
+        record("format 4 -> 3", line, after, 1);
+        p.extended = false;
+        line.opcode = mnemonicOf(line.opcode);
+        line.length = 3;
+        count++;
+    }
+    return count;
+}
+
+void Optimizer::printReport() const {
+    std::cout << "\n" << std::string(80, '=') << std::endl;
+    std::cout << "OPTIMIZER REPORT" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << std::left << std::setw(10) << "LOC"
+              << std::setw(16) << "Rule"
+              << std::setw(24) << "Before"
+              << std::setw(24) << "After"
+              << "Saved" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    for (const auto& change : changes) {
+        std::cout << "0x" << std::right << std::hex << std::uppercase << std::setfill('0')
+                  << std::setw(6) << change.location << "  "
+                  << std::left << std::dec << std::setfill(' ')
+                  << std::setw(16) << change.rule
+                  << std::setw(24) << change.before
+                  << std::setw(24) << (change.after.empty() ? "(removed)" : change.after)
+                  << change.bytesSaved << std::endl;
+    }
+    std::cout << std::string(80, '-') << std::endl;
+    for (const auto& note : notes) {
+        std::cout << "Note: " << note << std::endl;
+    }
+    std::cout << "Program length: " << lengthBefore << " -> " << lengthAfter << " bytes ("
+              << lengthBefore - lengthAfter << " saved)" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+}
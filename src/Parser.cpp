@@ -33,7 +33,10 @@ SourceLine Parser::parseLine(const std::string& line) {
         std::getline(iss, rest);
         result.operand = trim(rest);
     }
-    
+
+    result.comma = result.operand.find(',');
+    result.quote = result.operand.find('\'');
+    result.lastQuote = result.operand.rfind('\'');
     return result;
 }
 
@@ -47,3 +50,85 @@ std::string Parser::trim(const std::string& str) {
 bool Parser::startsWithWhitespace(const std::string& line) {
     return !line.empty() && (line[0] == ' ' || line[0] == '\t');
 }
+
+bool Parser::parseNumber(const std::string& str, int& value, int base) {
+    if (str.empty()) return false;
+    const char* first = str.data();
+    const char* last = first + str.size();
+    // 16진수는 std::stoi처럼 0x 접두사 허용
+    if (base == 16 && str.size() > 2 && str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) {
+        first += 2;
+    }
+    auto res = std::from_chars(first, last, value, base);
+    return res.ec == std::errc() && res.ptr == last;
+}
+
+int Parser::registerNumber(const std::string& reg) {
+    if (reg.size() == 2 && reg == "PC") return 8;
+    if (reg.size() == 2 && reg == "SW") return 9;
+    if (reg.size() != 1) return -1;
+    switch (reg[0]) {
+        case 'A': return 0;
+        case 'X': return 1;
+        case 'L': return 2;
+        case 'B': return 3;
+        case 'S': return 4;
+        case 'T': return 5;
+        case 'F': return 6;
+        default:  return -1;
+    }
+}
+
+Directive Parser::directiveOf(const std::string& opcode) {
+    if (opcode == "START") return Directive::START;
+    if (opcode == "END")   return Directive::END;
+    if (opcode == "WORD")  return Directive::WORD;
+    if (opcode == "BYTE")  return Directive::BYTE;
+    if (opcode == "RESW")  return Directive::RESW;
+    if (opcode == "RESB")  return Directive::RESB;
+    if (opcode == "EQU")   return Directive::EQU;
+    if (opcode == "USE")   return Directive::USE;
+    if (opcode == "IF")    return Directive::IF;
+    if (opcode == "ELSE")  return Directive::ELSE;
+    if (opcode == "ENDIF") return Directive::ENDIF;
+    if (opcode == "FILL")  return Directive::FILL;
+    return Directive::NONE;
+}
+
+// FILL 반복 수,값  (예: FILL 4096,0 / FILL 256,X'DEADBEEF' / FILL 10,C'AB')
+bool Parser::parseFillOperand(const std::string& operand, std::string& count, std::string& pattern) {
+    return parseFillOperand(operand, operand.find(','), count, pattern);
+}
+
+// comma: Scanner가 미리 찾은 첫 ',' 위치 (없으면 npos)
+bool Parser::parseFillOperand(const std::string& operand, size_t comma, std::string& count,
+                              std::string& pattern) {
+    if (comma == std::string::npos) return false;
+    count = trim(operand.substr(0, comma));
+    std::string value = trim(operand.substr(comma + 1));
+    pattern.clear();
+    if (count.empty() || value.empty()) return false;
+
+    if (value.size() >= 3 && (value[0] == 'X' || value[0] == 'C') && value[1] == '\'' &&
+        value.back() == '\'') {
+        std::string body = value.substr(2, value.size() - 3);
+        if (value[0] == 'C') {
+            pattern = body;
+            return !pattern.empty();
+        }
+        // X'...': 홀수 길이면 BYTE와 같이 앞에 0을 붙임
+        if (body.size() % 2 != 0) body = "0" + body;
+        for (size_t k = 0; k < body.size(); k += 2) {
+            int byte = 0;
+            if (!parseNumber(body.substr(k, 2), byte, 16) || byte < 0) return false;
+            pattern += static_cast<char>(byte);
+        }
+        return !pattern.empty();
+    }
+
+    int byte = 0;
+    bool hex = value.size() > 2 && value.compare(0, 2, "0x") == 0;
+    if (!parseNumber(value, byte, hex ? 16 : 10) || byte < 0 || byte > 0xFF) return false;
+    pattern = std::string(1, static_cast<char>(byte));
+    return true;
+}
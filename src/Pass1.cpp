@@ -1,199 +1,802 @@
 #include "../include/assembler.h"
+#include <cctype>
 
 Pass1::Pass1(OPTAB* opt, SYMTAB* sym) 
-    : optab(opt), symtab(sym), locctr(0), startAddr(0), programName("") {}
+    : optab(opt), symtab(sym), locctr(0), startAddr(0), programName(""),
+      currentBlock(0), packReservations(false), reserveBlock(-1), skipDepth(0), profiler(nullptr),
+      spill(nullptr) {
+    blocks.push_back({"", 0, 0});  // 기본 블록 (이름 없음)
+}
+
+void Pass1::setPackReservations(bool enable) {
+    packReservations = enable;
+}
+
+void Pass1::setProfiler(Profiler* prof) {
+    profiler = prof;
+}
+
+void Pass1::setSpill(IntermediateWriter* writer) {
+    spill = writer;
+}
+
+// 중간파일 라인 저장 (spill이 있으면 메모리에 두지 않고 바로 디스크로)
+void Pass1::emit(const IntermediateLine& line) {
+    if (spill != nullptr) {
+        spill->append(line);
+    } else {
+        intFile.push_back(line);
+    }
+}
+
+bool Pass1::finishSpill() {
+    if (spill == nullptr) return true;
+    std::vector<int> starts;
+    for (const auto& block : blocks) {
+        starts.push_back(block.start);
+    }
+    return spill->finish(startAddr, getProgramLength(), programName, starts, *symtab,
+                         optab->digest());
+}
+
+// ============================================================
+// 프로그램 블록 관리
+// ============================================================
+int Pass1::findOrAddBlock(const std::string& name) {
+    for (size_t k = 0; k < blocks.size(); ++k) {
+        if (blocks[k].name == name && static_cast<int>(k) != reserveBlock) {
+            return static_cast<int>(k);
+        }
+    }
+    blocks.push_back({name, 0, 0});
+    return static_cast<int>(blocks.size()) - 1;
+}
+
+// 블록을 정의 순서대로 이어 붙여 시작 주소 배정 (예약 블록은 항상 마지막)
+// 그 다음 중간파일과 SYMTAB의 블록 기준 주소를 최종 주소로 변환
+void Pass1::assignBlockAddresses() {
+    int addr = startAddr;
+    for (size_t k = 0; k < blocks.size(); ++k) {
+        if (static_cast<int>(k) == reserveBlock) continue;
+        blocks[k].start = addr;
+        addr += blocks[k].locctr;
+    }
+    if (reserveBlock >= 0) {
+        blocks[reserveBlock].start = addr;
+        addr += blocks[reserveBlock].locctr;
+    }
+    locctr = addr;
+
+    std::vector<int> starts;
+    for (const auto& block : blocks) {
+        starts.push_back(block.start);
+    }
+    for (auto& line : intFile) {
+        if (line.hasLocation) {
+            line.location += starts[line.block];
+        }
+    }
+    symtab->relocateBlocks(starts);
+}
+
+// 라인 길이가 바뀐 뒤 (최적화) 블록별 LOCCTR를 다시 누적하고 최종 주소를 재배정
+void Pass1::relayout() {
+    for (auto& block : blocks) {
+        block.locctr = 0;
+    }
+    std::vector<bool> seen(symtab->size(), false);
+    for (auto& line : intFile) {
+        if (!line.hasLocation) continue;
+        line.location = blocks[line.block].locctr;
+        blocks[line.block].locctr += line.length;
+
+        // 라벨 주소 갱신 (중복 라벨은 처음 정의만 유효)
+        if (!line.label.empty() && line.directive != Directive::START &&
+            line.directive != Directive::USE) {
+            int id = symtab->intern(line.label);
+            if (static_cast<size_t>(id) < seen.size() && !seen[id]) {
+                seen[id] = true;
+                symtab->redefine(id, line.location, line.block);
+            }
+        }
+    }
+    assignBlockAddresses();
+}
+
+// ============================================================
+// 피연산자 사전 분류 (Pass2가 문자열을 다시 해석하지 않도록)
+// ============================================================
+bool Pass1::classifyOperand(IntermediateLine& line, const SourceLine& source, int lineNum) {
+    ParsedOperand& p = line.parsed;
+    p = ParsedOperand();
+
+    // 표준 Format 4 표기 (+JSUB)
+    std::string mnemonic = line.opcode;
+    if (!mnemonic.empty() && mnemonic[0] == '+') {
+        p.extended = true;
+        mnemonic = mnemonic.substr(1);
+    }
+
+    std::string op = line.operand;
+    p.opId = optab->getId(mnemonic);
+
+    if (p.opId < 0) {
+        // 지시어 (Directive)
+        line.directive = Parser::directiveOf(mnemonic);
+        if (line.directive == Directive::NONE) {
+            Diagnostics::error("E100", lineNum, "Unknown opcode " + line.opcode);
+            return false;
+        }
+        switch (line.directive) {
+        case Directive::START:
+            if (!Parser::parseNumber(op, p.value, 16)) {
+                Diagnostics::error("E101", lineNum, "Invalid START address " + op);
+                return false;
+            }
+            p.isNumber = true;
+            return true;
+        case Directive::EQU:
+            // 16진수(0x) 또는 10진수 모두 처리
+            if (op.size() > 2 && op.compare(0, 2, "0x") == 0) {
+                p.isNumber = Parser::parseNumber(op, p.value, 16);
+            } else {
+                p.isNumber = Parser::parseNumber(op, p.value);
+            }
+            if (!p.isNumber) {
+                Diagnostics::error("E102", lineNum, "Invalid operand for EQU " + op);
+                return false;
+            }
+            return true;
+        case Directive::BYTE:
+            return true;  // C'...' / X'...'는 길이 계산과 Pass2에서 직접 처리
+        case Directive::FILL: {
+            // 반복 수는 RESB처럼 숫자 또는 앞에서 정의된 심볼, 패턴은 길이 계산과 Pass2에서 다시 분리
+            std::string count, pattern;
+            if (!Parser::parseFillOperand(op, source.comma, count, pattern)) {
+                Diagnostics::error("E116", lineNum, "Invalid operand for FILL " + op);
+                return false;
+            }
+            if (Parser::parseNumber(count, p.value)) {
+                p.isNumber = true;
+            } else {
+                p.symId = symtab->intern(count);
+            }
+            return true;
+        }
+        case Directive::USE:
+            return true;  // 피연산자는 블록 이름
+        case Directive::IF:
+        case Directive::ELSE:
+        case Directive::ENDIF:
+            return true;  // 조건식은 processConditional에서 평가
+        default:
+            // WORD, RESW, RESB, END: 숫자 또는 심볼
+            if (op.empty()) return true;
+            if (Parser::parseNumber(op, p.value)) {
+                p.isNumber = true;
+            } else {
+                p.symId = symtab->intern(op);
+            }
+            return true;
+        }
+    }
+
+    // 비표준 Format 4 표기 (피연산자 앞의 +)도 계속 허용
+    // 구분자 위치는 source.operand 기준이므로 앞에서 떼어 낸 글자 수(skipped)만큼 보정
+    size_t skipped = 0;
+    if (!op.empty() && op[0] == '+') {
+        p.extended = true;
+        op = op.substr(1);
+        skipped = 1;
+    }
+    size_t comma = (source.comma == std::string::npos) ? source.comma : source.comma - skipped;
+
+    const InstructionInfo& info = optab->getInfo(p.opId);
+    if (p.extended && info.format != 3) {
+        Diagnostics::error("E103", lineNum, "Format 4 not allowed for " + mnemonic);
+        return false;
+    }
+
+    if (info.format == 1) {
+        return true;
+    }
+
+    if (info.format == 2) {
+        std::string r1_str = Parser::trim(op.substr(0, comma));
+        std::string r2_str = (comma != std::string::npos) ? Parser::trim(op.substr(comma + 1)) : "";
 
-int Pass1::getInstructionLength(const std::string& mnemonic, const std::string& operand) {
-    if (!optab->isInstruction(mnemonic)) {
+        if (mnemonic == "SVC") {
+            // SVC n: 첫 번째 필드가 숫자
+            if (!Parser::parseNumber(r1_str, p.r1)) {
+                Diagnostics::error("E104", lineNum, "Invalid SVC number " + r1_str);
+                return false;
+            }
+            return true;
+        }
+
+        p.r1 = Parser::registerNumber(r1_str);
+        if (p.r1 < 0) {
+            Diagnostics::error("E105", lineNum, "Unknown register " + r1_str);
+            p.r1 = 0;
+            return false;
+        }
+        if (r2_str.empty()) return true;  // 1-register operand (e.g., TIXR X, CLEAR S)
+
+        if (mnemonic == "SHIFTL" || mnemonic == "SHIFTR") {
+            // SHIFTL/SHIFTR의 두 번째 피연산자는 숫자 (n-1 저장)
+            int n = 0;
+            if (!Parser::parseNumber(r2_str, n) || n < 1 || n > 16) {
+                Diagnostics::error("E106", lineNum, "Invalid shift count " + r2_str);
+                return false;
+            }
+            p.r2 = n - 1;
+        } else {
+            p.r2 = Parser::registerNumber(r2_str);
+            if (p.r2 < 0) {
+                Diagnostics::error("E105", lineNum, "Unknown register " + r2_str);
+                p.r2 = 0;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Format 3/4: 주소 지정 방식, 인덱스, 숫자/심볼
+    if (op.empty()) {
+        p.mode = AddrMode::NONE;  // RSUB
+        return true;
+    }
+    if (op[0] == '#' || op[0] == '@') {
+        p.mode = (op[0] == '#') ? AddrMode::IMMEDIATE : AddrMode::INDIRECT;
+        op = op.substr(1);
+        if (comma != std::string::npos) comma--;
+    } else {
+        p.mode = AddrMode::SIMPLE;
+    }
+
+    if (comma != std::string::npos && comma + 1 < op.size() && op[comma + 1] == 'X') {
+        p.indexed = true;
+        op = Parser::trim(op.substr(0, comma));
+    }
+
+    if (Parser::parseNumber(op, p.value)) {
+        p.isNumber = true;
+    } else {
+        p.symId = symtab->intern(op);
+    }
+    return true;
+}
+
+int Pass1::getInstructionLength(const IntermediateLine& line) {
+    const ParsedOperand& p = line.parsed;
+    if (p.opId < 0) {
         return 0;
     }
     
-    int format = optab->getFormat(mnemonic);
-    
     // Format 4 체크 (+ 접두사가 있는 경우)
-    if (!operand.empty() && operand[0] == '+') {
+    if (p.extended) {
         return 4;
     }
     
-    return format;
+    return optab->getInfo(p.opId).format;
 }
 
-int Pass1::getDirectiveLength(const std::string& directive, const std::string& operand,SYMTAB* symtab) {
-    int value = 0;
-
-    // 피연산자의 값을 확인 (숫자 or 심볼)
-    if (!operand.empty()) {
-        try {
-            // 1. 숫자인지 시도
-            value = std::stoi(operand);
-        } catch (const std::invalid_argument&) {
-            // 2. 숫자가 아니면 SYMTAB에서 심볼 조회
-            value = symtab->lookup(operand);
-            if (value == -1) {
-                // SYMTAB에도 없음 (아직 정의되지 않은 심볼 사용 등)
-                std::cerr << "Error: Undefined symbol '" << operand 
-                          << "' in directive " << directive << std::endl;
-                value = 0; // 오류 시 길이를 0으로 처리
-            }
+int Pass1::getDirectiveLength(const IntermediateLine& line, const SourceLine& source, int lineNum) {
+    const ParsedOperand& p = line.parsed;
+    const std::string& operand = line.operand;
+    int value = p.value;
+
+    // 피연산자가 심볼이면 지금 시점에 정의되어 있어야 함
+    if (p.symId >= 0 && (line.directive == Directive::RESW || line.directive == Directive::RESB ||
+                         line.directive == Directive::FILL)) {
+        value = symtab->addressOf(p.symId);
+        if (value == -1) {
+            // SYMTAB에도 없음 (아직 정의되지 않은 심볼 사용 등)
+            Diagnostics::error("E107", lineNum, "Undefined symbol '" + symtab->nameOf(p.symId) +
+                                                    "' in directive " + line.opcode);
+            value = 0; // 오류 시 길이를 0으로 처리
         }
     }
 
     // 값(value)을 기반으로 길이 계산
-    if (directive == "WORD") {
+    switch (line.directive) {
+    case Directive::WORD:
         return 3;
-    } else if (directive == "RESW") {
+    case Directive::RESW:
         return 3 * value; // value = 1 (e.g. RESW 1)
-    } else if (directive == "BYTE") {
+    case Directive::RESB:
+        return value; // value = 4096 (e.g. RESB BUFSIZE)
+    case Directive::BYTE:
+        // 따옴표 위치는 Scanner가 찾아 둔 것 사용 (C'/X'이면 첫 따옴표는 항상 1)
         if (operand.size() >= 3 && operand[0] == 'C' && operand[1] == '\'') {
-            size_t start = operand.find('\'');
-            size_t end = operand.rfind('\'');
+            size_t start = source.quote;
+            size_t end = source.lastQuote;
             if (start != std::string::npos && end != std::string::npos && end > start) {
                 return end - start - 1;
             }
         } else if (operand.size() >= 3 && operand[0] == 'X' && operand[1] == '\'') {
-            size_t start = operand.find('\'');
-            size_t end = operand.rfind('\'');
+            size_t start = source.quote;
+            size_t end = source.lastQuote;
             if (start != std::string::npos && end != std::string::npos && end > start) {
                 return (end - start - 1 + 1) / 2;
             }
         }
-    } else if (directive == "RESB") {
-        return value; // value = 4096 (e.g. RESB BUFSIZE)
-    } else if (directive == "EQU") {
-        return 0; // EQU는 길이 없음
+        return 0;
+    case Directive::FILL: {
+        // 반복 수와 무관하게 패턴 길이만 보고 크기 결정 (내용은 Pass2에서도 펼치지 않음)
+        std::string count, pattern;
+        Parser::parseFillOperand(operand, source.comma, count, pattern);
+        long long size = static_cast<long long>(value) * static_cast<long long>(pattern.size());
+        if (value < 0 || size > 0xFFFFF) {
+            Diagnostics::error("E116", lineNum, "FILL size out of range: " + operand);
+            return 0;
+        }
+        return static_cast<int>(size);
+    }
+    default:
+        return 0; // EQU 등은 길이 없음
+    }
+}
+
+// ============================================================
+// 조건부 어셈블리 (IF 조건 / ELSE / ENDIF)
+// ============================================================
+namespace {
+
+// opcode 필드가 name과 같은지 (문자열을 만들지 않고 비교)
+inline bool opcodeIs(const char* opcode, size_t length, const char* name) {
+    return length == std::char_traits<char>::length(name) &&
+           std::char_traits<char>::compare(opcode, name, length) == 0;
+}
+
+}  // namespace
+
+bool Pass1::inactive() const {
+    return !conditionals.empty() && !conditionals.back().active;
+}
+
+// 비활성 구간의 라인: opcode만 보고 중첩과 짝이 맞는 ELSE/ENDIF만 찾음
+void Pass1::skipLine(const char* opcode, size_t length, int lineNum) {
+    if (opcodeIs(opcode, length, "IF")) {
+        skipDepth++;
+    } else if (opcodeIs(opcode, length, "ENDIF")) {
+        if (skipDepth > 0) {
+            skipDepth--;
+        } else {
+            conditionals.pop_back();
+        }
+    } else if (opcodeIs(opcode, length, "ELSE") && skipDepth == 0) {
+        ConditionalFrame& frame = conditionals.back();
+        if (frame.seenElse) {
+            Diagnostics::error("E113", lineNum, "Duplicate ELSE for IF at line " +
+                                                    std::to_string(frame.lineNum));
+            return;
+        }
+        frame.seenElse = true;
+        frame.active = !frame.taken;
+        frame.taken = true;
+    }
+}
+
+// 조립 중인 구간의 IF/ELSE/ENDIF
+void Pass1::processConditional(const IntermediateLine& line, int lineNum) {
+    switch (line.directive) {
+    case Directive::IF: {
+        bool result = false;  // 조건이 잘못되면 거짓으로 보고 건너뜀
+        evaluateCondition(line.operand, lineNum, result);
+        conditionals.push_back({result, result, false, lineNum});
+        break;
+    }
+    case Directive::ELSE:
+        if (conditionals.empty()) {
+            Diagnostics::error("E113", lineNum, "ELSE without IF");
+        } else if (conditionals.back().seenElse) {
+            Diagnostics::error("E113", lineNum, "Duplicate ELSE for IF at line " +
+                                                    std::to_string(conditionals.back().lineNum));
+        } else {
+            // 여기까지 조립했으므로 참인 분기를 이미 지남
+            conditionals.back().seenElse = true;
+            conditionals.back().active = false;
+        }
+        break;
+    default:
+        if (conditionals.empty()) {
+            Diagnostics::error("E114", lineNum, "ENDIF without IF");
+        } else {
+            conditionals.pop_back();
+        }
+        break;
+    }
+}
+
+// 조건식: <항> 또는 <항> <비교> <항>  (비교: == != < <= > >=, 항: 숫자/0x16진수/절대 심볼)
+bool Pass1::evaluateCondition(const std::string& expr, int lineNum, bool& result) {
+    static const char* OPERATORS[] = {"==", "!=", "<=", ">=", "<", ">"};
+    size_t pos = std::string::npos;
+    std::string op;
+    for (const char* candidate : OPERATORS) {
+        pos = expr.find(candidate);
+        if (pos != std::string::npos) {
+            op = candidate;
+            break;
+        }
+    }
+
+    int lhs = 0, rhs = 0;
+    if (op.empty()) {
+        if (!evaluateTerm(Parser::trim(expr), lineNum, lhs)) return false;
+        result = lhs != 0;
+        return true;
     }
-    return 0;
+    if (!evaluateTerm(Parser::trim(expr.substr(0, pos)), lineNum, lhs) ||
+        !evaluateTerm(Parser::trim(expr.substr(pos + op.size())), lineNum, rhs)) {
+        return false;
+    }
+    if (op == "==") result = lhs == rhs;
+    else if (op == "!=") result = lhs != rhs;
+    else if (op == "<=") result = lhs <= rhs;
+    else if (op == ">=") result = lhs >= rhs;
+    else if (op == "<") result = lhs < rhs;
+    else result = lhs > rhs;
+    return true;
+}
+
+bool Pass1::evaluateTerm(const std::string& term, int lineNum, int& value) {
+    if (term.empty()) {
+        Diagnostics::error("E110", lineNum, "Invalid IF condition");
+        return false;
+    }
+    if (term.size() > 2 && term.compare(0, 2, "0x") == 0) {
+        if (Parser::parseNumber(term, value, 16)) return true;
+    } else if (Parser::parseNumber(term, value)) {
+        return true;
+    }
+    if (!std::isalpha(static_cast<unsigned char>(term[0]))) {
+        Diagnostics::error("E110", lineNum, "Invalid IF condition term " + term);
+        return false;
+    }
+
+    // 조건보다 앞에서 정의된 심볼만 (Pass1이므로 전방 참조 불가)
+    int id = symtab->intern(term);
+    if (!symtab->isDefined(id)) {
+        Diagnostics::error("E111", lineNum, "Undefined symbol " + term + " in IF condition");
+        return false;
+    }
+    // 블록 기준 주소는 Pass1이 끝나야 확정되므로 비교에 쓸 수 없음
+    if (symtab->isRelative(id) && symtab->blockOf(id) >= 0) {
+        Diagnostics::error("E112", lineNum, "Relocatable symbol " + term + " in IF condition");
+        return false;
+    }
+    value = symtab->addressOf(id);
+    return true;
+}
+
+// 입력이 끝났는데 닫히지 않은 IF 보고
+void Pass1::closeConditionals() {
+    for (const auto& frame : conditionals) {
+        Diagnostics::error("E115", frame.lineNum, "IF without matching ENDIF");
+    }
+    conditionals.clear();
+    skipDepth = 0;
 }
 
 bool Pass1::execute(const std::string& srcFilename) {
-    std::ifstream file(srcFilename);
+    std::ifstream file(srcFilename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot open source file: " << srcFilename << std::endl;
         return false;
     }
-    
-    std::string line;
+    int errorsBefore = Diagnostics::errorCount();
+
+    // 큰 버퍼 단위로 읽어서 Scanner로 라인 필드를 한꺼번에 분리
+    // (버퍼 끝의 미완성 라인은 다음 버퍼 앞으로 옮김)
+    const size_t CHUNK_SIZE = 1 << 22;
+    std::vector<char> buffer(CHUNK_SIZE);
+    std::vector<LineFields> lines;
+    size_t carry = 0;
     int lineNum = 0;
+    bool done = false;
+
+    while (!done) {
+        TRACE_SPAN("Pass1 chunk");
+        if (carry == buffer.size()) {
+            buffer.resize(buffer.size() * 2);  // 버퍼보다 긴 라인
+        }
+        file.read(buffer.data() + carry, buffer.size() - carry);
+        size_t size = carry + static_cast<size_t>(file.gcount());
+        bool final = !file;
+
+        if (profiler) profiler->begin("parse");
+        lines.clear();
+        size_t consumed = Scanner::scan(buffer.data(), size, lineNum, lines, final);
+        if (profiler) profiler->begin("Pass1");
+
+        for (const auto& fields : lines) {
+            if (inactive()) {
+                skipLine(buffer.data() + fields.opcodeBegin, fields.opcodeEnd - fields.opcodeBegin,
+                         fields.lineNum);
+                continue;
+            }
+            if (!processLine(Scanner::toSourceLine(buffer.data(), fields), fields.lineNum) ||
+                Diagnostics::shouldAbort()) {
+                lineNum = fields.lineNum;
+                done = true;
+                break;
+            }
+        }
+
+        carry = size - consumed;
+        std::copy(buffer.begin() + consumed, buffer.begin() + size, buffer.begin());
+        if (final) break;
+    }
     
-    while (std::getline(file, line)) {
-        lineNum++;
-        
-        // 빈 줄이나 주석 건너뛰기
-        if (line.empty()) continue;
-        
-        SourceLine parsed = Parser::parseLine(line);
-        
-        if (parsed.opcode.empty()) continue;
-        
-        // START 처리
-        if (parsed.opcode == "START") {
-            programName = parsed.label;
-            startAddr = std::stoi(parsed.operand, nullptr, 16);
-            locctr = startAddr;
-            
-            IntermediateLine intLine;
-            intLine.location = locctr;
-            intLine.label = parsed.label;
-            intLine.opcode = parsed.opcode;
-            intLine.operand = parsed.operand;
-            intLine.objcode = "";
-            intLine.hasLocation = true;
-            intFile.push_back(intLine);
-            continue;
+    file.close();
+
+    closeConditionals();
+
+    // 블록별 최종 주소 배정
+    assignBlockAddresses();
+    if (!finishSpill()) return false;
+
+    std::cout << "Pass 1 completed: " << lineNum << " lines processed" << std::endl;
+    return Diagnostics::errorCount() == errorsBefore;
+}
+
+// ============================================================
+// 파이프라인 실행: 읽기 스레드 -> 파싱 스레드 -> Pass1 (호출 스레드)
+// ============================================================
+namespace {
+
+struct ReadChunk {
+    std::vector<char> data;
+    size_t size = 0;
+    bool final = false;
+};
+
+// IF 구간 안의 라인은 조립할지 Pass1이 조건을 평가해야 알 수 있으므로
+// 파싱 스레드는 문자열을 만들지 않고 필드 위치와 원문만 넘김 (비활성이면 끝까지 문자열 없음)
+struct ParsedBatch {
+    std::vector<LineFields> fields;
+    std::vector<SourceLine> lines;  // fields와 짝, IF 구간 안의 라인은 비워 둠 (opcode가 빈 문자열)
+    std::vector<char> text;         // 비워 둔 라인이 있을 때만 보관하는 원문 (fields 위치 기준)
+    int lineCount = 0;              // final이면 전체 라인 수
+    bool final = false;
+};
+
+}  // namespace
+
+bool Pass1::executePipelined(const std::string& srcFilename) {
+    std::ifstream file(srcFilename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot open source file: " << srcFilename << std::endl;
+        return false;
+    }
+    int errorsBefore = Diagnostics::errorCount();
+
+    const size_t CHUNK_SIZE = 1 << 22;
+    SpscRing<ReadChunk> readRing(4);     // 읽기 -> 파싱
+    SpscRing<ReadChunk> freeRing(8);     // 파싱 -> 읽기 (버퍼 재사용)
+    SpscRing<ParsedBatch> parseRing(8);  // 파싱 -> Pass1
+    std::atomic<bool> cancel(false);
+
+    // 1. 읽기 스레드: 큰 버퍼를 채워서 넘김
+    std::thread reader([&]() {
+        while (true) {
+            TRACE_SPAN("read chunk");
+            ReadChunk chunk;
+            if (!freeRing.tryPop(chunk)) {
+                chunk.data.resize(CHUNK_SIZE);
+            }
+            file.read(chunk.data.data(), chunk.data.size());
+            chunk.size = static_cast<size_t>(file.gcount());
+            chunk.final = !file;
+            bool final = chunk.final;
+            if (!readRing.push(chunk, cancel) || final) break;
         }
-        // EQU 기계 독립적 기능 1
-        if (parsed.opcode == "EQU") {
-            if (parsed.label.empty()) {
-                std::cerr << "Error at line " << lineNum << ": EQU must have a label" << std::endl;
-                continue; // 이 라인 무시
+    });
+
+    // 2. 파싱 스레드: 이전 버퍼의 미완성 라인을 이어 붙인 뒤 Scanner로 분리
+    std::thread parser([&]() {
+        std::vector<char> work;
+        int lineNum = 0;
+        int depth = 0;  // 라인 모양만 보고 센 IF 중첩 (조건은 평가하지 않음)
+        while (true) {
+            ReadChunk chunk;
+            if (!readRing.pop(chunk, cancel)) break;
+            TRACE_SPAN("parse chunk");
+
+            work.insert(work.end(), chunk.data.begin(), chunk.data.begin() + chunk.size);
+            bool final = chunk.final;
+            freeRing.tryPush(chunk);  // 가득 차 있으면 그냥 버림
+
+            ParsedBatch batch;
+            size_t consumed = Scanner::scan(work.data(), work.size(), lineNum, batch.fields, final);
+
+            bool deferred = false;
+            batch.lines.resize(batch.fields.size());
+            for (size_t k = 0; k < batch.fields.size(); ++k) {
+                const LineFields& f = batch.fields[k];
+                const char* opcode = work.data() + f.opcodeBegin;
+                size_t length = f.opcodeEnd - f.opcodeBegin;
+                if (opcodeIs(opcode, length, "IF")) depth++;
+                if (depth > 0) {
+                    deferred = true;
+                } else {
+                    batch.lines[k] = Scanner::toSourceLine(work.data(), f);
+                }
+                if (depth > 0 && opcodeIs(opcode, length, "ENDIF")) depth--;
             }
-            
-            // (간단한 구현) 피연산자가 숫자라고 가정
-            // TODO: 나중에 'Expressions' 기능을 구현할 때 여기를 수정해야 함
-            int value = 0;
-            try {
-                // 16진수(0x) 또는 10진수 모두 처리
-                if (parsed.operand.size() > 2 && parsed.operand.substr(0, 2) == "0x") {
-                    value = std::stoi(parsed.operand.substr(2), nullptr, 16);
+            batch.final = final;
+            batch.lineCount = lineNum;
+
+            if (deferred) {
+                // 원문은 배치로 넘기고 미완성 라인만 새 버퍼로 복사
+                batch.text.swap(work);
+                work.assign(batch.text.begin() + consumed, batch.text.end());
+            } else {
+                work.erase(work.begin(), work.begin() + consumed);
+            }
+            if (!parseRing.push(batch, cancel) || final) break;
+        }
+    });
+
+    // 3. Pass1: 파싱된 라인을 순서대로 처리
+    int lineNum = 0;
+    bool done = false;
+    while (!done) {
+        ParsedBatch batch;
+        if (!parseRing.pop(batch, cancel)) break;
+        TRACE_SPAN("Pass1 batch");
+        for (size_t k = 0; k < batch.fields.size(); ++k) {
+            const LineFields& f = batch.fields[k];
+            const SourceLine& line = batch.lines[k];
+            bool deferred = line.opcode.empty();
+            lineNum = f.lineNum;
+            if (inactive()) {
+                if (deferred) {
+                    skipLine(batch.text.data() + f.opcodeBegin, f.opcodeEnd - f.opcodeBegin, lineNum);
                 } else {
-                    value = std::stoi(parsed.operand);
+                    skipLine(line.opcode.data(), line.opcode.size(), lineNum);
                 }
-            } catch (const std::exception& e) {
-                std::cerr << "Error at line " << lineNum << ": Invalid operand for EQU " << parsed.operand << std::endl;
                 continue;
             }
-
-            // SYMTAB에 (레이블, 값) 삽입
-            if (!symtab->insert(parsed.label, value)) {
-                 std::cerr << "Warning at line " << lineNum 
-                           << ": Duplicate symbol " << parsed.label << std::endl;
+            bool more = deferred ? processLine(Scanner::toSourceLine(batch.text.data(), f), lineNum)
+                                 : processLine(line, lineNum);
+            if (!more || Diagnostics::shouldAbort()) {
+                done = true;
+                break;
             }
-            
-            // INTFILE에 기록 (LOCCTR는 증가하지 않음)
-            IntermediateLine intLine;
-            intLine.location = 0; // EQU는 특정 주소가 없음 (혹은 현재 LOCCTR)
-            intLine.label = parsed.label;
-            intLine.opcode = parsed.opcode;
-            intLine.operand = parsed.operand;
-            intLine.objcode = "";
-            intLine.hasLocation = false; // 주소 미출력
-            intFile.push_back(intLine);
-
-            continue; // LOCCTR 증가 로직을 건너뜀
         }
-        
-        // END 처리
-        if (parsed.opcode == "END") {
-            IntermediateLine intLine;
-            intLine.location = 0;
-            intLine.label = parsed.label;
-            intLine.opcode = parsed.opcode;
-            intLine.operand = parsed.operand;
-            intLine.objcode = "";
-            intLine.hasLocation = false;
-            intFile.push_back(intLine);
+        if (batch.final) {
+            if (!done) lineNum = batch.lineCount;
             break;
         }
-        
-        // 현재 위치 저장
-        int currentLoc = locctr;
-        
-        // 라벨이 있으면 SYMTAB에 추가
-        if (!parsed.label.empty()) {
-            if (!symtab->insert(parsed.label, currentLoc)) {
-                std::cerr << "Warning at line " << lineNum 
-                          << ": Duplicate symbol " << parsed.label << std::endl;
-            }
+    }
+
+    // END 이후 남은 입력은 버리고 스레드 정리
+    cancel.store(true);
+    reader.join();
+    parser.join();
+    file.close();
+
+    closeConditionals();
+
+    // 블록별 최종 주소 배정
+    assignBlockAddresses();
+    if (!finishSpill()) return false;
+
+    std::cout << "Pass 1 completed: " << lineNum << " lines processed (pipelined)" << std::endl;
+    return Diagnostics::errorCount() == errorsBefore;
+}
+
+// 라인 하나 처리 (END를 만나면 false)
+bool Pass1::processLine(const SourceLine& parsed, int lineNum) {
+    IntermediateLine intLine;
+    intLine.location = blocks[currentBlock].locctr;
+    intLine.label = parsed.label;
+    intLine.opcode = parsed.opcode;
+    intLine.operand = parsed.operand;
+    intLine.objcode = "";
+    intLine.hasLocation = true;
+    intLine.block = currentBlock;
+    intLine.lineNum = lineNum;
+    bool valid = classifyOperand(intLine, parsed, lineNum);
+
+    // 조건부 어셈블리 지시어는 중간파일에 남기지 않음
+    if (intLine.directive == Directive::IF || intLine.directive == Directive::ELSE ||
+        intLine.directive == Directive::ENDIF) {
+        processConditional(intLine, lineNum);
+        return true;
+    }
+    
+    // START 처리 (블록 주소는 모두 0 기준, START 주소는 마지막에 더함)
+    if (intLine.directive == Directive::START) {
+        programName = parsed.label;
+        startAddr = intLine.parsed.value;
+        emit(intLine);
+        return true;
+    }
+    // USE 처리: 해당 블록의 LOCCTR로 전환 (피연산자 없으면 기본 블록)
+    if (intLine.directive == Directive::USE) {
+        currentBlock = findOrAddBlock(parsed.operand);
+        intLine.block = currentBlock;
+        intLine.location = blocks[currentBlock].locctr;
+        emit(intLine);
+        return true;
+    }
+    // EQU 기계 독립적 기능 1
+    if (intLine.directive == Directive::EQU) {
+        if (parsed.label.empty()) {
+            Diagnostics::error("E108", lineNum, "EQU must have a label");
+            return true; // 이 라인 무시
         }
-        
-        // 명령어 길이 계산
-        int length = 0;
-        if (optab->isInstruction(parsed.opcode)) {
-            length = getInstructionLength(parsed.opcode, parsed.operand);
-        } else {
-            length = getDirectiveLength(parsed.opcode, parsed.operand, symtab);
+        // TODO: 나중에 'Expressions' 기능을 구현할 때 여기를 수정해야 함
+        if (!valid) return true;
+
+        // SYMTAB에 (레이블, 값) 삽입
+        // EQU 상수는 절대값 (재배치 대상 아님)
+        if (!symtab->insert(parsed.label, intLine.parsed.value, false)) {
+            Diagnostics::error("E109", lineNum, "Duplicate symbol " + parsed.label);
         }
         
-        // 중간파일에 추가
-        IntermediateLine intLine;
-        intLine.location = currentLoc;
-        intLine.label = parsed.label;
-        intLine.opcode = parsed.opcode;
-        intLine.operand = parsed.operand;
-        intLine.objcode = "";
-        intLine.hasLocation = true;
-        intFile.push_back(intLine);
-        
-        // LOCCTR 증가
-        locctr += length;
+        // INTFILE에 기록 (LOCCTR는 증가하지 않음)
+        intLine.location = 0; // EQU는 특정 주소가 없음 (혹은 현재 LOCCTR)
+        intLine.hasLocation = false; // 주소 미출력
+        emit(intLine);
+
+        return true; // LOCCTR 증가 로직을 건너뜀
     }
     
-    file.close();
-    std::cout << "Pass 1 completed: " << lineNum << " lines processed" << std::endl;
+    // END 처리
+    if (intLine.directive == Directive::END) {
+        intLine.location = 0;
+        intLine.hasLocation = false;
+        emit(intLine);
+        return false;
+    }
+
+    // 예약 공간은 요청 시 마지막 블록으로 모아서 코드가 연속되도록 함
+    int block = currentBlock;
+    if (packReservations &&
+        (intLine.directive == Directive::RESW || intLine.directive == Directive::RESB)) {
+        if (reserveBlock < 0) {
+            blocks.push_back({"(RESERVE)", 0, 0});
+            reserveBlock = static_cast<int>(blocks.size()) - 1;
+        }
+        block = reserveBlock;
+    }
+    
+    // 현재 위치 저장
+    int currentLoc = blocks[block].locctr;
+    intLine.block = block;
+    intLine.location = currentLoc;
+    
+    // 라벨이 있으면 SYMTAB에 추가
+    if (!parsed.label.empty()) {
+        if (!symtab->insert(parsed.label, currentLoc, true, block)) {
+            Diagnostics::error("E109", lineNum, "Duplicate symbol " + parsed.label);
+        }
+    }
+    
+    // 명령어 길이 계산
+    int length = 0;
+    if (intLine.parsed.opId >= 0) {
+        length = getInstructionLength(intLine);
+    } else {
+        length = getDirectiveLength(intLine, parsed, lineNum);
+    }
+    intLine.length = length;
+    
+    // 중간파일에 추가
+    emit(intLine);
+    
+    // LOCCTR 증가
+    blocks[block].locctr += length;
     return true;
 }
 
 void Pass1::writeIntFile(const std::string& intFilename) {
+    TRACE_SPAN("write INTFILE");
     std::ofstream file(intFilename);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot write intermediate file" << std::endl;
@@ -211,8 +814,7 @@ void Pass1::writeIntFile(const std::string& intFilename) {
         file << std::left << std::setfill(' ')
              << std::setw(10) << line.label
              << std::setw(10) << line.opcode
-             << std::setw(20) << line.operand
-             << line.objcode << std::endl;
+             << std::setw(20) << line.operand << std::endl;  // objcode는 Pass2가 채우므로 비어 있음
     }
     
     file.close();
@@ -248,6 +850,31 @@ void Pass1::printIntFile() const {
     std::cout << std::string(80, '=') << std::endl;
 }
 
+void Pass1::printBlockTable() const {
+    std::cout << "\n" << std::string(60, '=') << std::endl;
+    std::cout << "PROGRAM BLOCKS" << std::endl;
+    std::cout << std::string(60, '=') << std::endl;
+    std::cout << std::left << std::setw(8) << "No."
+              << std::setw(20) << "Name"
+              << std::setw(16) << "Address"
+              << "Length" << std::endl;
+    std::cout << std::string(60, '-') << std::endl;
+
+    for (size_t k = 0; k < blocks.size(); ++k) {
+        std::cout << std::left << std::dec << std::setfill(' ') << std::setw(8) << k
+                  << std::setw(20) << (blocks[k].name.empty() ? "(default)" : blocks[k].name)
+                  << "0x" << std::right << std::hex << std::uppercase << std::setfill('0')
+                  << std::setw(6) << blocks[k].start << std::setfill(' ') << std::setw(8) << " "
+                  << "0x" << std::setfill('0') << std::setw(6) << blocks[k].locctr
+                  << std::dec << std::left << std::setfill(' ') << std::endl;
+    }
+    std::cout << std::string(60, '=') << std::endl;
+}
+
+int Pass1::getBlockCount() const {
+    return static_cast<int>(blocks.size());
+}
+
 int Pass1::getProgramLength() const {
     return locctr - startAddr;
 }
@@ -266,6 +893,10 @@ const std::vector<IntermediateLine>& Pass1::getIntFile() const {
     return intFile;
 }
 
+std::vector<IntermediateLine>& Pass1::getIntFile() {
+    return intFile;
+}
+
 std::string Pass1::getProgramName() const {
     return programName;
 }
\ No newline at end of file
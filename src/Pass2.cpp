@@ -1,20 +1,36 @@
 // ========== src/Pass2.cpp (신규 파일) ==========
 #include "../include/assembler.h"
+#include <cstdio>
+#include <cstring>
 
-Pass2::Pass2(OPTAB *opt, SYMTAB *sym, const std::vector<IntermediateLine> &intF,
+Pass2::Pass2(OPTAB *opt, SYMTAB *sym, std::vector<IntermediateLine> &intF,
              int start, int length, const std::string &progName)
-    : optab(opt), symtab(sym), intFile(intF), startAddr(start),
+    : optab(opt), symtab(sym), intFile(&intF), startAddr(start),
       programLength(length), programName(progName), firstExecAddr(start),
-      currentTextRecordStartAddr(0), currentTextRecordLength(0)
+      lineMap(nullptr), emitImage(false)
 {
-    // 레지스터 테이블 초기화
-    registers["A"] = 0;
-    registers["X"] = 1;
-    registers["L"] = 2;
-    registers["B"] = 3;
-    registers["S"] = 4;
-    registers["T"] = 5;
-    registers["F"] = 6;
+}
+
+Pass2::Pass2(OPTAB *opt, SYMTAB *sym, const IntermediateReader &reader)
+    : optab(opt), symtab(sym), intFile(nullptr), startAddr(reader.getStartAddress()),
+      programLength(reader.getProgramLength()), programName(reader.getProgramName()),
+      firstExecAddr(reader.getStartAddress()), lineMap(nullptr), emitImage(false)
+{
+}
+
+void Pass2::setTextRecordOptions(const TextRecordOptions &opts)
+{
+    textPacker = TextRecordPacker(opts);
+}
+
+void Pass2::setEmitImage(bool enable)
+{
+    emitImage = enable;
+}
+
+void Pass2::setLineMap(LineMap *map)
+{
+    lineMap = map;
 }
 
 // ============================================================
@@ -22,30 +38,39 @@ Pass2::Pass2(OPTAB *opt, SYMTAB *sym, const std::vector<IntermediateLine> &intF,
 // ============================================================
 std::string Pass2::generateObjectCode(IntermediateLine &line, int nextLoc)
 {
-    if (optab->isInstruction(line.opcode))
+    if (line.parsed.opId >= 0)
     {
-        // 명령어 (Instruction)
-        int format = optab->getFormat(line.opcode);
-
-        // 참고: 제공된 Pass1 코드는 Format 4를 비표준 방식(operand[0] == '+')으로
-        // 처리하려 하나, SRCFILE 예제에는 Format 4가 없으므로 Format 1, 2, 3만 구현합니다.
+        // 명령어 (Instruction): OPTAB 조회와 피연산자 해석은 Pass1에서 끝남
+        int format = optab->getInfo(line.parsed.opId).format;
 
         switch (format)
         {
         case 1:
+        {
+            TRACE_SPAN("format 1");
             return handleFormat1(line);
+        }
         case 2:
+        {
+            TRACE_SPAN("format 2");
             return handleFormat2(line);
+        }
         case 3:
+        {
+            TRACE_SPAN(line.parsed.extended ? "format 4" : "format 3");
             return handleFormat3(line, nextLoc);
+        }
         default:
-            std::cerr << "Error: Unknown format " << format << " for " << line.opcode << std::endl;
+            Diagnostics::error("E200", line.lineNum,
+                               "Unknown format " + std::to_string(format) + " for " + line.opcode,
+                               line.location);
             return "";
         }
     }
     else
     {
         // 지시어 (Directive)
+        TRACE_SPAN("directive");
         return handleDirective(line);
     }
 }
@@ -57,164 +82,187 @@ std::string Pass2::generateObjectCode(IntermediateLine &line, int nextLoc)
 // Format 1: Opcode (8 bits)
 std::string Pass2::handleFormat1(const IntermediateLine &line)
 {
-    return optab->getOpcode(line.opcode);
+    int obj = optab->getInfo(line.parsed.opId).opcodeValue;
+    storeImage(line.location, obj, 1);
+    return intToHex(obj, 2);
 }
 
 // Format 2: Opcode (8 bits) + r1 (4 bits) + r2 (4 bits)
 std::string Pass2::handleFormat2(const IntermediateLine &line)
 {
-    std::string obj = optab->getOpcode(line.opcode);
-    std::string op = line.operand;
-
-    size_t comma = op.find(',');
-    if (comma != std::string::npos)
-    {
-        // 2-register operand
-        std::string r1_str = Parser::trim(op.substr(0, comma));
-        std::string r2_str = Parser::trim(op.substr(comma + 1));
-
-        int r1 = getRegisterNum(r1_str);
-        int r2 = 0; // r2 기본값
-
-        // SHIFTL/SHIFTR의 두 번째 피연산자는 숫자
-        if (line.opcode == "SHIFTL" || line.opcode == "SHIFTR")
-        {
-            r2 = std::stoi(r2_str) - 1; // n-1 저장
-        }
-        else
-        {
-            r2 = getRegisterNum(r2_str);
-        }
-
-        obj += intToHex(r1, 1);
-        obj += intToHex(r2, 1);
-    }
-    else
-    {
-        // 1-register operand (e.g., TIXR X, CLEAR S)
-        std::string r1_str = Parser::trim(op);
-        int r1 = getRegisterNum(r1_str);
-        obj += intToHex(r1, 1);
-        obj += "0"; // r2는 0
-    }
-    return obj;
+    const ParsedOperand &op = line.parsed;
+    int opcode_val = optab->getInfo(op.opId).opcodeValue;
+    int obj = (opcode_val << 8) | ((op.r1 & 0xF) << 4) | (op.r2 & 0xF);
+    storeImage(line.location, obj, 2);
+    return intToHex(obj, 4);
 }
 
-// Format 3: Opcode (6b) + nixbpe (6b) + disp (12b)
-std::string Pass2::handleFormat3(const IntermediateLine &line, int nextLoc)
+// Format 3/4 주소 지정: n,i,x,b,p,e 플래그와 변위(주소)를 결정 (목적 코드는 만들지 않음)
+// 피연산자가 미정의이거나 필드에 담을 수 없으면 진단을 보고하고 false
+bool Pass2::resolveFormat3(const IntermediateLine &line, int nextLoc, Format3Fields &f)
 {
-    int opcode_val = hexStringToInt(optab->getOpcode(line.opcode));
-    int n = 0, i = 0, x = 0, b = 0, p = 0, e = 0;
-    int disp = 0;
+    const ParsedOperand &op = line.parsed;
+    f = Format3Fields();
+    bool ok = true;
     int target_addr = 0;
 
-    std::string op = line.operand;
-    std::string clean_op = op;
-
     // 1. n, i 플래그 기본값 설정
-    if (op.empty())
-    { // RSUB
-        n = 1;
-        i = 1;
-        target_addr = 0;
-    }
-    else if (op[0] == '#')
-    { // Immediate
-        n = 0;
-        i = 1;
-        p = 0; // Immediate는 non-relative
-        clean_op = op.substr(1);
-    }
-    else if (op[0] == '@')
-    { // Indirect
-        n = 1;
-        i = 0;
-        p = 1; // PC-relative가 기본
-        clean_op = op.substr(1);
-    }
-    else
-    { // Simple
-        n = 1;
-        i = 1;
-        p = 1; // PC-relative가 기본
-    }
-
-    // 2. x 플래그 설정 (Indexed)
-    size_t comma_x = clean_op.find(",X");
-    if (comma_x != std::string::npos)
+    switch (op.mode)
     {
-        x = 1;
-        clean_op = Parser::trim(clean_op.substr(0, comma_x));
+    case AddrMode::NONE: // RSUB
+        f.n = 1;
+        f.i = 1;
+        break;
+    case AddrMode::IMMEDIATE:
+        f.n = 0;
+        f.i = 1;
+        f.p = 0; // Immediate는 non-relative
+        break;
+    case AddrMode::INDIRECT:
+        f.n = 1;
+        f.i = 0;
+        f.p = 1; // PC-relative가 기본
+        break;
+    case AddrMode::SIMPLE:
+        f.n = 1;
+        f.i = 1;
+        f.p = 1; // PC-relative가 기본
+        break;
     }
 
+    // 2. x, e 플래그 설정 (Indexed, Extended)
+    f.x = op.indexed ? 1 : 0;
+    f.e = op.extended ? 1 : 0;
+
     // 3. Target Address 계산
-    if (line.opcode == "RSUB")
+    if (op.mode == AddrMode::NONE)
     {
-        p = 0; // RSUB는 주소 필드 0, non-relative
+        f.p = 0; // RSUB는 주소 필드 0, non-relative
     }
-    else if (symtab->exists(clean_op))
+    else if (op.isNumber)
+    {
+        // 피연산자가 상수(숫자)이면 Simple/Direct 모드로 취급
+        // PC-relative(p=1)가 아닌 12-bit 주소(p=0)를 사용
+        target_addr = op.value;
+        f.p = 0;
+    }
+    else if (symtab->isDefined(op.symId))
     {
         // 피연산자가 심볼 (e.g., J begin)
-        target_addr = symtab->lookup(clean_op);
-        // p=1 (PC-relative)는 위에서 이미 설정됨
+        target_addr = symtab->addressOf(op.symId);
     }
     else
     {
-        // 피연산자가 심볼이 아님 -> 상수로 시도
-        try
-        {
-            target_addr = std::stoi(clean_op);
-            
-            // [!] 여기가 핵심 수정 사항입니다.
-            // 피연산자가 상수(숫자)이면, Simple/Direct 모드로 취급
-            // (n=1, i=1은 이미 설정됨)
-            // PC-relative(p=1)가 아닌 12-bit 주소(p=0)를 사용하도록 설정
-            p = 0;
-        }
-        catch (const std::exception &)
+        Diagnostics::error("E201", line.lineNum, "Undefined symbol " + line.operand,
+                           line.location);
+        target_addr = 0;
+        f.p = 0;
+        ok = false;
+    }
+
+    // 재배치 대상 심볼을 절대 주소로 담는 필드는 M 레코드 필요
+    f.relocatable = (op.mode != AddrMode::NONE) && !op.isNumber && symtab->isRelative(op.symId);
+    // 재배치 심볼의 즉시값(#label)도 PC-relative로 담으면 M 레코드 없이 어디에 적재해도 맞음
+    if (ok && op.mode == AddrMode::IMMEDIATE && f.relocatable)
+    {
+        f.p = 1;
+    }
+
+    // Format 4: 20-bit 절대 주소 (즉시값은 음수도 2의 보수로 허용)
+    if (f.e == 1)
+    {
+        int low = (op.mode == AddrMode::IMMEDIATE) ? -(1 << 19) : 0;
+        if (ok && (target_addr < low || target_addr > 0xFFFFF))
         {
-            // #, @ 없이 심볼 테이블에도 없는 피연산자
-            std::cerr << "Error at 0x" << std::hex << line.location
-                      << ": Symbol not found and not a number: " << clean_op << std::endl;
-            target_addr = 0;
-            p = 0;
+            Diagnostics::error("E204", line.lineNum,
+                               "Operand " + line.operand + " does not fit in 20 bits", line.location);
+            ok = false;
         }
+        f.disp = target_addr & 0xFFFFF;
+        return ok;
     }
 
     // 4. disp 계산 (모드에 따라)
-    if (n == 0 && i == 1)
+    bool fits = true;
+    if (f.n == 0 && f.i == 1 && f.p == 0)
     { // Mode 1: Immediate (e.g. LDA #0)
-        disp = target_addr;
+        f.disp = target_addr;
+        fits = op.isNumber ? (target_addr >= -2048 && target_addr <= 0xFFF)
+                           : (target_addr >= 0 && target_addr <= 0xFFF);
     }
-    else if (p == 1)
-    { // Mode 2: PC-relative (e.g. J begin)
+    else if (f.p == 1)
+    { // Mode 2: PC-relative (e.g. J begin, LDB #length)
         int pc = nextLoc;
         int disp_pc = target_addr - pc;
 
         if (disp_pc >= -2048 && disp_pc <= 2047)
         {
             // PC-relative 성공
-            b = 0;
-            disp = disp_pc & 0xFFF; // 12비트 2's complement
+            f.b = 0;
+            f.disp = disp_pc & 0xFFF; // 12비트 2's complement
         }
         else
         {
             // PC-relative 실패 (TODO: Base-relative 시도)
-            p = 0;
-            b = 0;
-            disp = target_addr & 0xFFF; // 12-bit Direct로 fallback
+            f.p = 0;
+            f.b = 0;
+            f.disp = target_addr & 0xFFF; // 12-bit Direct로 fallback
+            fits = target_addr >= 0 && target_addr <= 0xFFF;
         }
     }
     else
     { // Mode 3: Simple/Direct (p=0, b=0)
         // (e.g. RSUB, 또는 COMP 48)
-        disp = target_addr & 0xFFF;
+        f.disp = target_addr & 0xFFF;
+        fits = target_addr >= 0 && target_addr <= 0xFFF;
+    }
+    if (ok && !fits)
+    {
+        Diagnostics::error("E204", line.lineNum,
+                           "Displacement for " + line.operand + " out of range (use +" +
+                               optab->getInfo(op.opId).mnemonic + ")",
+                           line.location);
+        ok = false;
+    }
+    // PC-relative로 담을 수 없는 재배치 심볼: 12비트 절대 필드는 로더가 재배치하면 넘치므로
+    // M 레코드 대신 Format 4를 요구
+    if (ok && f.relocatable && f.p == 0 && f.b == 0)
+    {
+        Diagnostics::error("E205", line.lineNum,
+                           "Relocatable operand " + line.operand + " needs +" +
+                               optab->getInfo(op.opId).mnemonic + " (format 4)",
+                           line.location);
+        ok = false;
+    }
+    return ok;
+}
+
+// Format 3: Opcode (6b) + nixbpe (6b) + disp (12b)
+// Format 4: Opcode (6b) + nixbpe (6b) + address (20b)
+std::string Pass2::handleFormat3(const IntermediateLine &line, int nextLoc)
+{
+    Format3Fields f;
+    resolveFormat3(line, nextLoc, f);
+    int opcode_val = optab->getInfo(line.parsed.opId).opcodeValue;
+    int first_byte = opcode_val + (f.n << 1) + f.i;
+
+    // Format 4: 20-bit 절대 주소
+    if (f.e == 1)
+    {
+        if (f.relocatable)
+        {
+            addModRecord(line.location + 1, 5);
+        }
+        int flags = (f.x << 3) + f.e;
+        long long obj = (static_cast<long long>(first_byte) << 24) | (flags << 20) | (f.disp & 0xFFFFF);
+        storeImage(line.location, obj, 4);
+        return intToHex(obj, 8);
     }
 
     // 5. 조립
-    int first_byte = opcode_val + (n << 1) + i;
-    int flags = (x << 3) + (b << 2) + (p << 1) + e;
-    int obj = (first_byte << 16) | (flags << 12) | (disp & 0xFFF);
+    int flags = (f.x << 3) + (f.b << 2) + (f.p << 1) + f.e;
+    int obj = (first_byte << 16) | (flags << 12) | (f.disp & 0xFFF);
+    storeImage(line.location, obj, 3);
 
     return intToHex(obj, 6);
 }
@@ -223,126 +271,406 @@ std::string Pass2::handleFormat3(const IntermediateLine &line, int nextLoc)
 std::string Pass2::handleDirective(const IntermediateLine& line) {
     std::string op = line.operand;
     
-    if (line.opcode == "WORD") {
-        int val = std::stoi(op);
+    if (line.directive == Directive::WORD) {
+        int val = line.parsed.value;
+        if (line.parsed.symId >= 0) {
+            val = symtab->addressOf(line.parsed.symId);
+            if (val == -1) {
+                Diagnostics::error("E202", line.lineNum, "Undefined symbol in WORD: " + op,
+                                   line.location);
+                val = 0;
+            }
+            else if (symtab->isRelative(line.parsed.symId))
+            {
+                addModRecord(line.location, 6);
+            }
+        }
+        storeImage(line.location, val, 3);
         return intToHex(val, 6);
         
-    } else if (line.opcode == "BYTE") {
+    } else if (line.directive == Directive::BYTE) {
         if (op.size() >= 3 && op[0] == 'C' && op[1] == '\'') {
             // C'...'
             std::string str_val = op.substr(2, op.length() - 3);
             std::string obj = "";
+            int loc = line.location;
             for (char c : str_val) {
                 obj += intToHex(static_cast<int>(c), 2);
+                storeImage(loc++, static_cast<unsigned char>(c), 1);
             }
             return obj;
         } else if (op.size() >= 3 && op[0] == 'X' && op[1] == '\'') {
             // X'...'
             std::string hex_val = op.substr(2, op.length() - 3);
             // 헥사 코드가 홀수 길이면 앞에 0을 붙여 짝수로 만듦
-            return (hex_val.length() % 2 == 0) ? hex_val : "0" + hex_val;
+            if (hex_val.length() % 2 != 0) hex_val = "0" + hex_val;
+            if (emitImage) {
+                for (size_t k = 0; k + 1 < hex_val.length(); k += 2) {
+                    int value = 0;
+                    if (Parser::parseNumber(hex_val.substr(k, 2), value, 16)) {
+                        storeImage(line.location + static_cast<int>(k / 2), value, 1);
+                    }
+                }
+            }
+            return hex_val;
         }
-    } else if (line.opcode == "RESW" || line.opcode == "RESB") {
-        // T 레코드 분리
+    } else if (line.directive == Directive::RESW || line.directive == Directive::RESB) {
+        // 목적 코드 없음 (다음 코드의 주소가 건너뛰므로 T 레코드는 거기서 나뉨)
         return "";
     }
     return "";
 }
 
 // ============================================================
-// T 레코드 관리 헬퍼
+// M 레코드 관리
 // ============================================================
 
-void Pass2::startNewTextRecord(int loc)
+void Pass2::addModRecord(int loc, int halfBytes)
 {
-    flushTextRecord(); // 이전 레코드가 있다면 완료
-    currentTextRecordStartAddr = loc;
-    currentTextRecordLength = 0;
-    currentTextRecord = "T" + intToHex(loc, 6);
+    TRACE_SPAN("M record");
+    // M[시작 기준 주소(6)][길이(2)]
+    std::string record = "M" + intToHex(loc - startAddr, 6) + intToHex(halfBytes, 2);
+    if (modSpill.is_open())
+    {
+        modSpill << record << '\n';
+    }
+    else
+    {
+        modRecords.push_back(record);
+    }
 }
 
-void Pass2::appendToTextRecord(const std::string &objCode, int loc)
+// ============================================================
+// 메모리 이미지
+// ============================================================
+
+// value의 하위 bytes 바이트를 빅엔디언으로 loc 위치에 기록 (SIC/XE 바이트 순서)
+void Pass2::storeImage(int loc, long long value, int bytes)
 {
-    if (objCode.empty())
-    { // RESW, RESB
-        flushTextRecord();
+    if (!emitImage)
+    {
         return;
     }
-
-    int codeBytes = objCode.length() / 2;
-
-    // 현재 T 레코드가 꽉 찼거나(최대 30바이트), 주소가 연속적이지 않을 때
-    if ((currentTextRecordLength + codeBytes > 30) || (loc != currentTextRecordStartAddr + currentTextRecordLength))
+    int offset = loc - startAddr;
+    for (int k = bytes - 1; k >= 0; --k, ++offset)
     {
-        startNewTextRecord(loc);
+        if (offset >= 0 && offset < static_cast<int>(image.size()))
+        {
+            image[offset] = static_cast<unsigned char>((value >> (k * 8)) & 0xFF);
+        }
     }
-
-    currentTextRecord += objCode;
-    currentTextRecordLength += codeBytes;
 }
 
-void Pass2::flushTextRecord()
+// pattern을 length 바이트만큼 반복 기록 (1바이트면 memset, 아니면 채운 부분을 두 배씩 복사)
+void Pass2::fillImage(int loc, const std::string &pattern, int length)
 {
-    if (currentTextRecordLength > 0)
+    if (!emitImage)
+    {
+        return;
+    }
+    int offset = loc - startAddr;
+    if (offset < 0 || offset >= static_cast<int>(image.size()))
     {
-        // T[주소(6)][길이(2)][코드...]
-        currentTextRecord.insert(7, intToHex(currentTextRecordLength, 2));
-        textRecords.push_back(currentTextRecord);
+        return;
+    }
+    length = std::min(length, static_cast<int>(image.size()) - offset);
+    unsigned char *dst = image.data() + offset;
+    if (pattern.size() == 1)
+    {
+        std::memset(dst, static_cast<unsigned char>(pattern[0]), static_cast<size_t>(length));
+        return;
+    }
+    int filled = std::min(length, static_cast<int>(pattern.size()));
+    std::memcpy(dst, pattern.data(), static_cast<size_t>(filled));
+    while (filled < length)
+    {
+        int chunk = std::min(filled, length - filled);
+        std::memcpy(dst + filled, dst, static_cast<size_t>(chunk));
+        filled += chunk;
     }
-    currentTextRecord = "";
-    currentTextRecordLength = 0;
-    currentTextRecordStartAddr = 0;
 }
 
 // ============================================================
 // Pass 2 메인 실행 함수
 // ============================================================
 
-bool Pass2::execute()
+// H 레코드 생성, 이미지 준비
+void Pass2::beginProgram()
 {
-    std::cout << "\n[Step 4] Running Pass 2..." << std::endl;
-
-    // 1. H 레코드 생성
     std::string progNamePadded = programName;
     progNamePadded.resize(6, ' ');
     headerRecord = "H" + progNamePadded + intToHex(startAddr, 6) + intToHex(programLength, 6);
 
-    // 2. T, E 레코드 생성
-    for (size_t i = 0; i < intFile.size(); ++i)
+    // 예약 영역(RESW/RESB)은 0으로 남음
+    if (emitImage)
     {
-        IntermediateLine &line = intFile[i]; // objcode 저장을 위해 non-const 참조
+        image.assign(static_cast<size_t>(std::max(programLength, 0)), 0);
+    }
+}
 
-        if (line.opcode == "START")
+// 코드를 만드는 라인 하나 (주소 오름차순으로 호출)
+void Pass2::processLine(IntermediateLine &line)
+{
+    if (line.directive == Directive::FILL)
+    {
+        processFill(line);
+        return;
+    }
+
+    // 목적 코드 생성 (PC = 다음 명령어 주소)
+    int nextLoc = line.location + line.length;
+    std::string objCode = generateObjectCode(line, nextLoc);
+
+    // 중간파일(리스트)에 목적 코드 저장
+    line.objcode = objCode;
+
+    // T 레코드에 추가 (WORD/BYTE 데이터는 레코드 경계에서 나눌 수 있음)
+    textPacker.append(objCode, line.location, line.parsed.opId < 0);
+
+    // 주소 -> 소스 라인 (예약 영역은 소스 없음으로 남김)
+    if (lineMap != nullptr && !objCode.empty())
+    {
+        lineMap->add(line.location, line.length, line.lineNum);
+    }
+}
+
+// FILL 반복 수,값: 패턴만 넘겨 T(또는 F) 레코드와 이미지를 바로 채움
+// (반복 수는 Pass1이 정한 길이에서 다시 구함, 리스팅에는 패턴과 반복 수만 표시)
+void Pass2::processFill(IntermediateLine &line)
+{
+    std::string countText, pattern;
+    if (!Parser::parseFillOperand(line.operand, countText, pattern) || line.length == 0)
+    {
+        return;  // 피연산자 오류는 Pass1에서 보고됨
+    }
+    int count = line.length / static_cast<int>(pattern.size());
+    textPacker.appendRun(pattern, count, line.location);
+    fillImage(line.location, pattern, line.length);
+
+    std::string objCode;
+    for (char c : pattern)
+    {
+        objCode += intToHex(static_cast<unsigned char>(c), 2);
+    }
+    if (count > 1)
+    {
+        objCode += " x" + std::to_string(count);
+    }
+    line.objcode = objCode;
+
+    if (lineMap != nullptr)
+    {
+        lineMap->add(line.location, line.length, line.lineNum);
+    }
+}
+
+// E 레코드 생성, 마지막 T 레코드 저장
+void Pass2::endProgram(const IntermediateLine *endLine)
+{
+    if (endLine != nullptr)
+    {
+        if (endLine->parsed.symId >= 0)
+        {
+            if (symtab->isDefined(endLine->parsed.symId))
+            {
+                firstExecAddr = symtab->addressOf(endLine->parsed.symId);
+            }
+            else
+            {
+                Diagnostics::error("E203", endLine->lineNum,
+                                   "Undefined symbol in END: " + endLine->operand);
+            }
+        }
+        endRecord = "E" + intToHex(firstExecAddr, 6);
+    }
+    textPacker.finish();
+    if (lineMap != nullptr)
+    {
+        lineMap->finish();
+    }
+}
+
+bool Pass2::execute()
+{
+    std::cout << "\n[Step 4] Running Pass 2..." << std::endl;
+    int errorsBefore = Diagnostics::errorCount();
+
+    // 1. H 레코드 생성
+    beginProgram();
+
+    // 2. 코드를 만드는 라인을 주소순으로 정렬
+    //    (USE 블록이 있으면 소스 순서와 주소 순서가 다르므로 블록별로 연속 출력)
+    std::vector<IntermediateLine> &lines = *intFile;
+    std::vector<size_t> order;
+    const IntermediateLine *endLine = nullptr;
+    for (size_t i = 0; i < lines.size(); ++i)
+    {
+        const IntermediateLine &line = lines[i];
+        if (line.directive == Directive::END)
+        {
+            endLine = &line;
+            break;
+        }
+        if (!line.hasLocation || line.directive == Directive::START || line.directive == Directive::USE)
         {
             continue;
         }
+        order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&lines](size_t a, size_t b)
+                     { return lines[a].location < lines[b].location; });
 
-        if (line.opcode == "END")
+    // 3. T 레코드 생성
+    for (size_t i : order)
+    {
+        if (Diagnostics::shouldAbort())
         {
-            // E 레코드 생성
-            if (!line.operand.empty())
-            {
-                firstExecAddr = symtab->lookup(line.operand);
-            }
-            endRecord = "E" + intToHex(firstExecAddr, 6);
             break;
         }
+        processLine(lines[i]);
+    }
 
-        // 목적 코드 생성
-        int nextLoc = (i + 1 < intFile.size()) ? intFile[i + 1].location : line.location;
-        std::string objCode = generateObjectCode(line, nextLoc);
+    // 4. E 레코드 생성, 마지막 T 레코드 저장
+    endProgram(endLine);
 
-        // 중간파일(리스트)에 목적 코드 저장
-        line.objcode = objCode;
+    if (Diagnostics::errorCount() != errorsBefore)
+    {
+        return false;
+    }
+    std::cout << "Pass 2 completed successfully" << std::endl;
+    return true;
+}
 
-        // T 레코드에 추가
-        appendToTextRecord(objCode, line.location);
+// ============================================================
+// 검사 전용 (--check): execute와 같은 해석/범위 검사, 인코딩과 레코드 생성은 생략
+// ============================================================
+void Pass2::checkLine(const IntermediateLine &line)
+{
+    if (line.parsed.opId >= 0)
+    {
+        int format = optab->getInfo(line.parsed.opId).format;
+        if (format == 3)
+        {
+            Format3Fields fields;
+            resolveFormat3(line, line.location + line.length, fields);
+        }
+        else if (format != 1 && format != 2)
+        {
+            Diagnostics::error("E200", line.lineNum,
+                               "Unknown format " + std::to_string(format) + " for " + line.opcode,
+                               line.location);
+        }
     }
+    else if (line.directive == Directive::WORD && line.parsed.symId >= 0 &&
+             !symtab->isDefined(line.parsed.symId))
+    {
+        Diagnostics::error("E202", line.lineNum, "Undefined symbol in WORD: " + line.operand,
+                           line.location);
+    }
+}
 
-    // 3. 마지막 T 레코드 저장
-    flushTextRecord();
+bool Pass2::check()
+{
+    int errorsBefore = Diagnostics::errorCount();
+    const IntermediateLine *endLine = nullptr;
+    for (const IntermediateLine &line : *intFile)
+    {
+        if (Diagnostics::shouldAbort())
+        {
+            break;
+        }
+        if (line.directive == Directive::END)
+        {
+            endLine = &line;
+            break;
+        }
+        if (!line.hasLocation || line.directive == Directive::START || line.directive == Directive::USE)
+        {
+            continue;
+        }
+        checkLine(line);
+    }
+    endProgram(endLine);  // END 피연산자 검사
+    return Diagnostics::errorCount() == errorsBefore;
+}
+
+// ============================================================
+// 중간파일 모드: mmap한 레코드를 순차적으로 읽으며 OBJFILE을 바로 씀
+// ============================================================
+bool Pass2::executeOutOfCore(const IntermediateReader &reader, const std::string &objFilename)
+{
+    std::cout << "\n[Step 4] Running Pass 2 (out-of-core)..." << std::endl;
+    int errorsBefore = Diagnostics::errorCount();
+
+    std::ofstream file(objFilename);
+    std::string modFilename = objFilename + ".mod";
+    modSpill.open(modFilename, std::ios::trunc);
+    if (!file.is_open() || !modSpill.is_open())
+    {
+        std::cerr << "Error: Cannot write object file" << std::endl;
+        return false;
+    }
+
+    beginProgram();
+    file << headerRecord << '\n';
+    textPacker.setSink(&file);
+
+    // 리더가 레코드를 블록 시작 주소순으로 모아 두었으므로 한 번 순서대로 읽으면 전체가 주소순
+    // (같은 블록에서 END 뒤의 라인은 조립하지 않음)
+    const uint64_t RELEASE_INTERVAL = 1 << 16;
+    IntermediateLine line;
+    IntermediateLine endLine;
+    bool hasEnd = false;
+    for (uint64_t k = 0; k < reader.size() && !Diagnostics::shouldAbort(); ++k)
+    {
+        if (k % RELEASE_INTERVAL == 0)
+        {
+            reader.release(k);  // 지나간 페이지는 내려놓아 RSS를 일정하게 유지
+        }
+        reader.read(k, line);
+        if (hasEnd && line.block == endLine.block)
+        {
+            continue;
+        }
+        if (line.directive == Directive::END)
+        {
+            endLine = line;
+            hasEnd = true;
+            continue;
+        }
+        if (!line.hasLocation || line.directive == Directive::START || line.directive == Directive::USE)
+        {
+            continue;
+        }
+        processLine(line);
+    }
+    reader.release(reader.size());
+    endProgram(hasEnd ? &endLine : nullptr);
+
+    // M 레코드는 T 레코드 뒤에 옴
+    modSpill.close();
+    std::ifstream mods(modFilename);
+    if (mods.peek() != std::ifstream::traits_type::eof())
+    {
+        file << mods.rdbuf();
+    }
+    mods.close();
+    std::remove(modFilename.c_str());
+    file << endRecord << '\n';
+    file.close();
+    if (!file)
+    {
+        std::cerr << "Error: Failed to write object file: " << objFilename << std::endl;
+        return false;
+    }
+    if (Diagnostics::errorCount() != errorsBefore)
+    {
+        std::remove(objFilename.c_str());  // 오류가 있는 목적 프로그램은 남기지 않음
+        return false;
+    }
 
     std::cout << "Pass 2 completed successfully" << std::endl;
+    std::cout << "\nObject file written: " << objFilename << std::endl;
     return true;
 }
 
@@ -352,6 +680,7 @@ bool Pass2::execute()
 
 void Pass2::writeObjFile(const std::string &objFilename) const
 {
+    TRACE_SPAN("write OBJFILE");
     std::ofstream file(objFilename);
     if (!file.is_open())
     {
@@ -360,103 +689,145 @@ void Pass2::writeObjFile(const std::string &objFilename) const
     }
 
     file << headerRecord << std::endl;
-    for (const auto &tRec : textRecords)
+    for (const auto &tRec : textPacker.getRecords())
     {
         file << tRec << std::endl;
     }
+    for (const auto &mRec : modRecords)
+    {
+        file << mRec << std::endl;
+    }
     file << endRecord << std::endl;
 
     file.close();
     std::cout << "\nObject file written: " << objFilename << std::endl;
 }
 
-void Pass2::printObjFile() const
+// 평면 이미지(IMGFILE)와 사이드카 헤더 저장
+bool Pass2::writeImageFile(const std::string &imgFilename, const std::string &headerFilename) const
 {
-    std::cout << "\n"
-              << std::string(80, '=') << std::endl;
-    std::cout << "OBJECT PROGRAM (OBJFILE)" << std::endl;
-    std::cout << std::string(80, '=') << std::endl;
-    std::cout << headerRecord << std::endl;
-    for (const auto &tRec : textRecords)
+    TRACE_SPAN("write IMGFILE");
+    std::ofstream file(imgFilename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Error: Cannot write image file: " << imgFilename << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char *>(image.data()), static_cast<std::streamsize>(image.size()));
+    file.close();
+
+    MemoryImageHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "SXIM", 4);
+    header.version = 1;
+    header.loadAddress = static_cast<uint32_t>(startAddr);
+    header.length = static_cast<uint32_t>(image.size());
+    header.entryPoint = static_cast<uint32_t>(firstExecAddr);
+    std::memcpy(header.name, programName.data(), std::min(programName.size(), sizeof(header.name)));
+
+    std::ofstream hdr(headerFilename, std::ios::binary);
+    if (!hdr.is_open())
+    {
+        std::cerr << "Error: Cannot write image header: " << headerFilename << std::endl;
+        return false;
+    }
+    hdr.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    hdr.close();
+    std::cout << "\nMemory image written: " << imgFilename << " (" << image.size()
+              << " bytes, header " << headerFilename << ")" << std::endl;
+    return true;
+}
+
+void Pass2::printObjFile(std::ostream &out) const
+{
+    out << "\n"
+        << std::string(80, '=') << std::endl;
+    out << "OBJECT PROGRAM (OBJFILE)" << std::endl;
+    out << std::string(80, '=') << std::endl;
+    out << headerRecord << std::endl;
+    for (const auto &tRec : textPacker.getRecords())
+    {
+        out << tRec << std::endl;
+    }
+    for (const auto &mRec : modRecords)
     {
-        std::cout << tRec << std::endl;
+        out << mRec << std::endl;
     }
-    std::cout << endRecord << std::endl;
-    std::cout << std::string(80, '=') << std::endl;
+    out << endRecord << std::endl;
+    out << std::string(80, '=') << std::endl;
+}
+
+void Pass2::printTextRecordSummary(std::ostream &out) const
+{
+    textPacker.printSummary(out);
 }
 
 // INTFILE에 목적 코드가 채워진 '리스트 파일' 출력
-void Pass2::printListingFile() const
+void Pass2::printListingFile(std::ostream &out) const
 {
-    std::cout << "\n"
-              << std::string(80, '=') << std::endl;
-    std::cout << "PROGRAM LISTING (with Object Code)" << std::endl;
-    std::cout << std::string(80, '=') << std::endl;
-    std::cout << std::left
-              << std::setw(10) << "LOC"
-              << std::setw(10) << "LABEL"
-              << std::setw(10) << "OPCODE"
-              << std::setw(20) << "OPERAND"
-              << "OBJCODE" << std::endl;
-    std::cout << std::string(80, '-') << std::endl;
-
-    for (const auto &line : intFile)
-    {
-        if (line.opcode == "START" || line.opcode == "END")
+    out << "\n"
+        << std::string(80, '=') << std::endl;
+    out << "PROGRAM LISTING (with Object Code)" << std::endl;
+    out << std::string(80, '=') << std::endl;
+    out << std::left
+        << std::setw(10) << "LOC"
+        << std::setw(10) << "LABEL"
+        << std::setw(10) << "OPCODE"
+        << std::setw(20) << "OPERAND"
+        << "OBJCODE" << std::endl;
+    out << std::string(80, '-') << std::endl;
+
+    if (intFile == nullptr)
+    {
+        out << "(listing is not kept in out-of-core mode)" << std::endl;
+        out << std::string(80, '=') << std::endl;
+        return;
+    }
+    for (const auto &line : *intFile)
+    {
+        if (line.directive == Directive::START || line.directive == Directive::END)
         {
-            std::cout << "          " // no loc
-                      << std::left << std::setfill(' ')
-                      << std::setw(10) << line.label
-                      << std::setw(10) << line.opcode
-                      << std::setw(20) << line.operand << std::endl;
+            out << "          " // no loc
+                << std::left << std::setfill(' ')
+                << std::setw(10) << line.label
+                << std::setw(10) << line.opcode
+                << std::setw(20) << line.operand << std::endl;
             continue;
         }
 
         if (line.hasLocation)
         {
-            std::cout << "0x" << std::hex << std::uppercase
-                      << std::setw(6) << std::setfill('0') << line.location << "  ";
+            out << "0x" << std::hex << std::uppercase
+                << std::setw(6) << std::setfill('0') << line.location << "  ";
         }
         else
         {
-            std::cout << "          ";
+            out << "          ";
         }
 
-        std::cout << std::dec << std::left << std::setfill(' ')
-                  << std::setw(10) << line.label
-                  << std::setw(10) << line.opcode
-                  << std::setw(20) << line.operand
-                  << line.objcode << std::endl;
+        out << std::dec << std::left << std::setfill(' ')
+            << std::setw(10) << line.label
+            << std::setw(10) << line.opcode
+            << std::setw(20) << line.operand
+            << line.objcode << std::endl;
     }
-    std::cout << std::string(80, '=') << std::endl;
+    out << std::string(80, '=') << std::endl;
 }
 
 // ============================================================
 // 유틸리티 함수
 // ============================================================
 
-std::string Pass2::intToHex(int val, int width) const
+std::string Pass2::intToHex(long long val, int width) const
 {
-    std::stringstream ss;
-    // C++의 2의 보수 표현을 이용하여 음수도 올바르게 마스킹
-    unsigned long long mask = (1ULL << (width * 4)) - 1;
-    ss << std::hex << std::uppercase << std::setfill('0') << std::setw(width)
-       << (static_cast<unsigned long long>(val) & mask);
-    return ss.str();
-}
-
-int Pass2::hexStringToInt(const std::string &hexStr) const
-{
-    return std::stoi(hexStr, nullptr, 16);
-}
-
-int Pass2::getRegisterNum(const std::string &reg) const
-{
-    auto it = registers.find(reg);
-    if (it != registers.end())
+    // 2의 보수 표현을 이용하여 음수도 올바르게 마스킹 (stringstream 없이 직접 변환)
+    static const char digits[] = "0123456789ABCDEF";
+    unsigned long long v = static_cast<unsigned long long>(val);
+    std::string out(width, '0');
+    for (int k = width - 1; k >= 0; --k)
     {
-        return it->second;
+        out[k] = digits[v & 0xF];
+        v >>= 4;
     }
-    std::cerr << "Warning: Unknown register " << reg << std::endl;
-    return 0; // 기본값 0 (A)
-}
\ No newline at end of file
+    return out;
+}
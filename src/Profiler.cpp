@@ -0,0 +1,162 @@
+#include "../include/assembler.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// ============================================================
+// 전역 할당 카운터
+// ============================================================
+namespace {
+
+std::atomic<unsigned long long> g_allocCount(0);
+std::atomic<unsigned long long> g_allocBytes(0);
+std::atomic<unsigned long long> g_liveBytes(0);
+std::atomic<unsigned long long> g_peakLiveBytes(0);
+
+}  // namespace
+
+#ifdef ASM_TRACK_ALLOC
+
+namespace {
+
+// 해제 시 크기를 알 수 있도록 블록 앞에 크기를 기록 (정렬 유지를 위해 max_align_t 크기)
+const size_t HEADER_SIZE = alignof(std::max_align_t);
+
+void* trackedAlloc(size_t size) {
+    void* raw = std::malloc(size + HEADER_SIZE);
+    if (raw == nullptr) return nullptr;
+    *static_cast<size_t*>(raw) = size;
+
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    unsigned long long live = g_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    unsigned long long peak = g_peakLiveBytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(raw) + HEADER_SIZE;
+}
+
+void trackedFree(void* ptr) {
+    if (ptr == nullptr) return;
+    void* raw = static_cast<char*>(ptr) - HEADER_SIZE;
+    g_liveBytes.fetch_sub(*static_cast<size_t*>(raw), std::memory_order_relaxed);
+    std::free(raw);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    void* ptr = trackedAlloc(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    void* ptr = trackedAlloc(size);
+    if (ptr == nullptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+
+#endif
+
+// ============================================================
+// Profiler
+// ============================================================
+Profiler::Profiler() : current(-1), countAtStart(0), bytesAtStart(0) {}
+
+bool Profiler::allocTrackingEnabled() {
+#ifdef ASM_TRACK_ALLOC
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Profiler::begin(const std::string& phase) {
+    if (current >= 0 && phases[current].name == phase) return;  // 이미 진행 중
+    end();
+
+    current = -1;
+    for (size_t k = 0; k < phases.size(); ++k) {
+        if (phases[k].name == phase) {
+            current = static_cast<int>(k);
+            break;
+        }
+    }
+    if (current < 0) {
+        PhaseStats stats;
+        stats.name = phase;
+        phases.push_back(stats);
+        current = static_cast<int>(phases.size()) - 1;
+    }
+
+    // 단계 안의 최대 사용량을 보기 위해 peak를 현재 사용량으로 초기화
+    g_peakLiveBytes.store(g_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    countAtStart = g_allocCount.load(std::memory_order_relaxed);
+    bytesAtStart = g_allocBytes.load(std::memory_order_relaxed);
+    phaseStart = std::chrono::steady_clock::now();
+}
+
+void Profiler::end() {
+    if (current < 0) return;
+    auto now = std::chrono::steady_clock::now();
+    PhaseStats& stats = phases[current];
+    stats.millis += std::chrono::duration<double, std::milli>(now - phaseStart).count();
+    stats.allocCount += g_allocCount.load(std::memory_order_relaxed) - countAtStart;
+    stats.allocBytes += g_allocBytes.load(std::memory_order_relaxed) - bytesAtStart;
+    stats.peakLiveBytes = std::max(stats.peakLiveBytes, g_peakLiveBytes.load(std::memory_order_relaxed));
+#ifdef ASM_TRACE
+    Trace::record(Trace::intern(stats.name), phaseStart, now);  // 단계 구간도 타임라인에 표시
+#endif
+    current = -1;
+}
+
+void Profiler::report() const {
+    std::cout << "\n" << std::string(80, '=') << std::endl;
+    std::cout << "PROFILE (time / heap allocations per phase)" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << std::left << std::setw(16) << "Phase"
+              << std::right << std::setw(12) << "Time(ms)"
+              << std::setw(14) << "Allocs"
+              << std::setw(18) << "Bytes"
+              << std::setw(18) << "Peak live" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+
+    PhaseStats total;
+    total.name = "TOTAL";
+    for (const auto& stats : phases) {
+        total.millis += stats.millis;
+        total.allocCount += stats.allocCount;
+        total.allocBytes += stats.allocBytes;
+        total.peakLiveBytes = std::max(total.peakLiveBytes, stats.peakLiveBytes);
+    }
+
+    std::vector<PhaseStats> rows = phases;
+    rows.push_back(total);
+    for (const auto& stats : rows) {
+        std::cout << std::left << std::dec << std::setfill(' ') << std::setw(16) << stats.name
+                  << std::right << std::setw(12) << std::fixed << std::setprecision(3) << stats.millis;
+        if (allocTrackingEnabled()) {
+            std::cout << std::setw(14) << stats.allocCount
+                      << std::setw(18) << stats.allocBytes
+                      << std::setw(18) << stats.peakLiveBytes;
+        } else {
+            std::cout << std::setw(14) << "n/a" << std::setw(18) << "n/a" << std::setw(18) << "n/a";
+        }
+        std::cout << std::left << std::defaultfloat << std::endl;
+    }
+    std::cout << std::string(80, '=') << std::endl;
+    if (!allocTrackingEnabled()) {
+        std::cout << "(build with -DASM_TRACK_ALLOC to collect heap statistics)" << std::endl;
+    }
+}
@@ -1,26 +1,115 @@
 #include "../include/assembler.h"
+#include <cstring>
 
 SYMTAB::SYMTAB() {}
 
-bool SYMTAB::insert(const std::string& symbol, int address) {
-    if (exists(symbol)) {
-        std::cerr << "Error: Duplicate symbol '" << symbol << "'" << std::endl;
-        return false;
+bool SYMTAB::insert(const std::string& symbol, int address, bool relative, int block) {
+    // 전방 참조로 이미 ID가 있으면 그 항목을 정의로 채움 (스냅샷 계층 심볼은 덮어씀)
+    SymbolEntry& entry = symbols[intern(symbol)];
+    if (entry.defined && !entry.fromLayer) {
+        return false;  // 중복 정의 (진단은 호출한 쪽에서 라인 정보와 함께 보고)
     }
-    table[symbol] = address;
+    entry.address = address;
+    entry.defined = true;
+    entry.relative = relative;
+    entry.block = relative ? block : -1;
+    entry.fromLayer = false;
     return true;
 }
 
-int SYMTAB::lookup(const std::string& symbol) const {
+int SYMTAB::intern(const std::string& symbol) {
     auto it = table.find(symbol);
     if (it != table.end()) {
         return it->second;
     }
+    int id = static_cast<int>(symbols.size());
+    symbols.push_back({symbol, -1, false, true, 0, false});
+    table[symbol] = id;
+
+    // 읽기 전용 계층에 있으면 외부 절대 주소로 정의된 것으로 취급
+    if (layer) {
+        int index = layer->find(symbol);
+        if (index >= 0) {
+            SymbolEntry& entry = symbols[id];
+            entry.address = static_cast<int>(layer->entry(index).address);
+            entry.defined = true;
+            entry.relative = false;
+            entry.block = -1;
+            entry.fromLayer = true;
+        }
+    }
+    return id;
+}
+
+int SYMTAB::lookup(const std::string& symbol) const {
+    auto it = table.find(symbol);
+    if (it != table.end()) {
+        return addressOf(it->second);
+    }
+    if (layer) {
+        int index = layer->find(symbol);
+        if (index >= 0) return static_cast<int>(layer->entry(index).address);
+    }
     return -1;
 }
 
 bool SYMTAB::exists(const std::string& symbol) const {
-    return table.find(symbol) != table.end();
+    auto it = table.find(symbol);
+    if (it != table.end()) {
+        return symbols[it->second].defined;
+    }
+    return layer && layer->find(symbol) >= 0;
+}
+
+bool SYMTAB::isDefined(int id) const {
+    return id >= 0 && id < static_cast<int>(symbols.size()) && symbols[id].defined;
+}
+
+int SYMTAB::addressOf(int id) const {
+    return isDefined(id) ? symbols[id].address : -1;
+}
+
+bool SYMTAB::isRelative(int id) const {
+    return isDefined(id) && symbols[id].relative;
+}
+
+int SYMTAB::blockOf(int id) const {
+    return isDefined(id) ? symbols[id].block : -1;
+}
+
+const std::string& SYMTAB::nameOf(int id) const {
+    return symbols[id].name;
+}
+
+int SYMTAB::size() const {
+    return static_cast<int>(symbols.size());
+}
+
+bool SYMTAB::redefine(int id, int address, int block) {
+    SymbolEntry& entry = symbols[id];
+    if (!entry.defined || !entry.relative || entry.fromLayer) {
+        return false;  // 상수(EQU), 외부 심볼은 그대로
+    }
+    entry.address = address;
+    entry.block = block;
+    return true;
+}
+
+void SYMTAB::undefine(int id) {
+    SymbolEntry& entry = symbols[id];
+    if (!entry.fromLayer) {
+        entry.defined = false;
+        entry.address = -1;
+    }
+}
+
+void SYMTAB::relocateBlocks(const std::vector<int>& blockStarts) {
+    for (auto& sym : symbols) {
+        if (sym.defined && sym.relative && sym.block >= 0 &&
+            sym.block < static_cast<int>(blockStarts.size())) {
+            sym.address += blockStarts[sym.block];
+        }
+    }
 }
 
 void SYMTAB::print() const {
@@ -33,17 +122,21 @@ void SYMTAB::print() const {
     std::cout << std::string(60, '-') << std::endl;
     
     for (const auto& entry : table) {
-        std::cout << std::left << std::setw(25) << entry.first 
-                  << "0x" << std::hex << std::uppercase 
-                  << std::setw(18) << std::setfill('0') << std::setw(4)
-                  << entry.second 
-                  << std::dec << std::setw(15) << entry.second 
-                  << std::setfill(' ') << std::endl;
+        const SymbolEntry& sym = symbols[entry.second];
+        if (!sym.defined || sym.fromLayer) continue;
+        // 16진 주소는 0으로 채워 오른쪽 정렬, 나머지 칸은 공백 (다시 읽을 수 있는 형식)
+        std::ostringstream hex;
+        hex << "0x" << std::hex << std::uppercase << std::right
+            << std::setw(4) << std::setfill('0') << sym.address;
+        std::cout << std::left << std::setfill(' ') << std::setw(25) << entry.first 
+                  << std::setw(20) << hex.str()
+                  << std::dec << std::setw(15) << sym.address << std::endl;
     }
     std::cout << std::string(60, '=') << std::endl;
 }
 
 void SYMTAB::writeToFile(const std::string& filename) const {
+    TRACE_SPAN("write SYMTAB");
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Cannot write SYMTAB file" << std::endl;
@@ -59,13 +152,116 @@ void SYMTAB::writeToFile(const std::string& filename) const {
     file << std::string(60, '-') << std::endl;
     
     for (const auto& entry : table) {
-        file << std::left << std::setw(25) << entry.first 
-             << "0x" << std::hex << std::uppercase 
-             << std::setw(18) << std::setfill('0') << std::setw(4)
-             << entry.second 
-             << std::dec << std::setw(15) << entry.second 
-             << std::setfill(' ') << std::endl;
+        const SymbolEntry& sym = symbols[entry.second];
+        if (!sym.defined || sym.fromLayer) continue;
+        // 16진 주소는 0으로 채워 오른쪽 정렬, 나머지 칸은 공백 (다시 읽을 수 있는 형식)
+        std::ostringstream hex;
+        hex << "0x" << std::hex << std::uppercase << std::right
+            << std::setw(4) << std::setfill('0') << sym.address;
+        file << std::left << std::setfill(' ') << std::setw(25) << entry.first 
+             << std::setw(20) << hex.str()
+             << std::dec << std::setw(15) << sym.address << std::endl;
     }
     file << std::string(60, '=') << std::endl;
     file.close();
 }
+
+// ============================================================
+// 바이너리 스냅샷 (호스트 바이트 순서)
+// ============================================================
+bool SYMTAB::writeSnapshot(const std::string& filename) const {
+    TRACE_SPAN("write SYMTAB.bin");
+    // 이 모듈에서 정의한 심볼만, 주소순 (같은 주소는 이름순)
+    std::vector<const SymbolEntry*> defined;
+    for (const auto& entry : table) {
+        const SymbolEntry& sym = symbols[entry.second];
+        if (sym.defined && !sym.fromLayer) defined.push_back(&sym);
+    }
+    std::stable_sort(defined.begin(), defined.end(),
+                     [](const SymbolEntry* a, const SymbolEntry* b) { return a->address < b->address; });
+
+    std::vector<SymbolSnapshot::Entry> entries;
+    std::string strings;
+    for (const SymbolEntry* sym : defined) {
+        SymbolSnapshot::Entry e;
+        e.address = static_cast<uint32_t>(sym->address);
+        e.nameOffset = static_cast<uint32_t>(strings.size());
+        e.nameLength = static_cast<uint32_t>(sym->name.size());
+        e.flags = sym->relative ? SymbolSnapshot::FLAG_RELATIVE : 0;
+        entries.push_back(e);
+        strings += sym->name;
+        strings += '\0';
+    }
+
+    // 해시 색인: 적재율 50% 이하 (선형 탐사)
+    uint32_t hashSize = 1;
+    while (hashSize < entries.size() * 2 + 1) hashSize <<= 1;
+    std::vector<uint32_t> hashIndex(hashSize, 0);
+    for (size_t k = 0; k < entries.size(); ++k) {
+        uint32_t slot = SymbolSnapshot::hashName(strings.data() + entries[k].nameOffset,
+                                                 entries[k].nameLength) & (hashSize - 1);
+        while (hashIndex[slot] != 0) slot = (slot + 1) & (hashSize - 1);
+        hashIndex[slot] = static_cast<uint32_t>(k + 1);
+    }
+
+    SymbolSnapshot::Header header;
+    std::memcpy(header.magic, "SYMB", 4);
+    header.version = SymbolSnapshot::VERSION;
+    header.count = static_cast<uint32_t>(entries.size());
+    header.hashSize = hashSize;
+    header.stringBytes = static_cast<uint32_t>(strings.size());
+    header.reserved = 0;
+
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot write symbol snapshot" << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SymbolSnapshot::Entry));
+    file.write(reinterpret_cast<const char*>(hashIndex.data()), hashIndex.size() * sizeof(uint32_t));
+    file.write(strings.data(), strings.size());
+    file.close();
+    std::cout << "Symbol snapshot written: " << filename << " (" << entries.size() << " symbols)" << std::endl;
+    return true;
+}
+
+bool SYMTAB::loadSnapshot(const std::string& filename, bool readOnlyLayer) {
+    std::shared_ptr<SymbolSnapshot> snapshot = std::make_shared<SymbolSnapshot>();
+    if (!snapshot->open(filename)) {
+        return false;
+    }
+
+    if (readOnlyLayer) {
+        layer = snapshot;
+        // 이미 참조만 된 심볼은 지금 계층에서 찾아 둠
+        for (auto& sym : symbols) {
+            if (sym.defined) continue;
+            int index = layer->find(sym.name);
+            if (index >= 0) {
+                sym.address = static_cast<int>(layer->entry(index).address);
+                sym.defined = true;
+                sym.relative = false;
+                sym.block = -1;
+                sym.fromLayer = true;
+            }
+        }
+        std::cout << "Symbol layer attached: " << filename << " (" << layer->size() << " symbols)" << std::endl;
+        return true;
+    }
+
+    // 미리 채우기: 다른 모듈의 최종 주소이므로 계층 심볼처럼 외부 심볼로 표시
+    // (블록 재배치, relayout, SYMTAB.txt/SYMTAB.bin 출력에서 제외, 로컬 정의가 덮어씀)
+    for (int k = 0; k < snapshot->size(); ++k) {
+        const SymbolSnapshot::Entry& e = snapshot->entry(k);
+        SymbolEntry& entry = symbols[intern(snapshot->nameOf(e))];
+        if (entry.defined && !entry.fromLayer) continue;
+        entry.address = static_cast<int>(e.address);
+        entry.defined = true;
+        entry.relative = (e.flags & SymbolSnapshot::FLAG_RELATIVE) != 0;
+        entry.block = -1;
+        entry.fromLayer = true;
+    }
+    std::cout << "Symbols preloaded: " << filename << " (" << snapshot->size() << " symbols)" << std::endl;
+    return true;
+}
@@ -0,0 +1,216 @@
+#include "../include/assembler.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+// 공백류: ' ', '\t', '\v', '\f', '\r' (istringstream >> 와 같은 구분, 개행 제외)
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// 입력 64바이트마다 바이트 종류별 비트마스크 (비트 k = 블록의 k번째 바이트)
+struct ClassBlock {
+    uint64_t newline;
+    uint64_t space;
+    uint64_t quote;
+    uint64_t comma;
+};
+
+#if defined(__AVX2__)
+
+const size_t VECTOR_SIZE = 32;
+
+// 32바이트를 한 번 읽어 네 종류를 모두 비교하고 block의 shift 위치에 채움
+inline void classifyVector(const char* p, ClassBlock& block, unsigned shift) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i nl = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n'));
+    // 9..13 범위 검사: (v - 9)를 부호 없이 4와 비교, 그 중 '\n'(10)은 제외
+    __m256i shifted = _mm256_sub_epi8(v, _mm256_set1_epi8(9));
+    __m256i inRange = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(4)), shifted);
+    __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),
+                                    _mm256_andnot_si256(nl, inRange));
+    __m256i quote = _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\''));
+    __m256i comma = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','));
+    block.newline |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(nl))) << shift;
+    block.space |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(space))) << shift;
+    block.quote |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(quote))) << shift;
+    block.comma |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(comma))) << shift;
+}
+
+#elif defined(__SSE2__)
+
+const size_t VECTOR_SIZE = 16;
+
+// 16바이트를 한 번 읽어 네 종류를 모두 비교하고 block의 shift 위치에 채움
+inline void classifyVector(const char* p, ClassBlock& block, unsigned shift) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i nl = _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'));
+    // 9..13 범위 검사: (v - 9)를 부호 없이 4와 비교, 그 중 '\n'(10)은 제외
+    __m128i shifted = _mm_sub_epi8(v, _mm_set1_epi8(9));
+    __m128i inRange = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(4)), shifted);
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 _mm_andnot_si128(nl, inRange));
+    __m128i quote = _mm_cmpeq_epi8(v, _mm_set1_epi8('\''));
+    __m128i comma = _mm_cmpeq_epi8(v, _mm_set1_epi8(','));
+    block.newline |= static_cast<uint64_t>(_mm_movemask_epi8(nl)) << shift;
+    block.space |= static_cast<uint64_t>(_mm_movemask_epi8(space)) << shift;
+    block.quote |= static_cast<uint64_t>(_mm_movemask_epi8(quote)) << shift;
+    block.comma |= static_cast<uint64_t>(_mm_movemask_epi8(comma)) << shift;
+}
+
+#endif
+
+// 버퍼 전체를 64바이트 블록 단위로 한 번만 분류
+// 벡터 로드는 버퍼 크기(size)를 넘지 않는 블록에서만 수행하고 마지막 조각은 스칼라로 처리
+void classify(const char* data, size_t size, std::vector<ClassBlock>& blocks) {
+    blocks.resize((size + 63) / 64);
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        ClassBlock& block = blocks[b];
+        block = ClassBlock{0, 0, 0, 0};
+        size_t base = b * 64;
+        size_t count = std::min<size_t>(64, size - base);
+#if defined(__AVX2__) || defined(__SSE2__)
+        if (count == 64) {
+            for (unsigned k = 0; k < 64; k += VECTOR_SIZE) {
+                classifyVector(data + base + k, block, k);
+            }
+            continue;
+        }
+#endif
+        for (size_t k = 0; k < count; ++k) {
+            char c = data[base + k];
+            uint64_t bit = uint64_t(1) << k;
+            if (c == '\n') block.newline |= bit;
+            else if (isSpace(c)) block.space |= bit;
+            else if (c == '\'') block.quote |= bit;
+            else if (c == ',') block.comma |= bit;
+        }
+    }
+}
+
+// [from, end)에서 field 비트가 켜진 첫 위치 (flip이 ~0이면 꺼진 위치, 없으면 end)
+inline size_t findNext(const ClassBlock* blocks, uint64_t ClassBlock::*field, uint64_t flip,
+                       size_t from, size_t end) {
+    if (from >= end) return end;
+    size_t b = from / 64;
+    size_t last = (end - 1) / 64;
+    uint64_t word = (blocks[b].*field ^ flip) & (~uint64_t(0) << (from % 64));
+    while (word == 0) {
+        if (b == last) return end;
+        word = blocks[++b].*field ^ flip;
+    }
+    size_t pos = b * 64 + static_cast<size_t>(__builtin_ctzll(word));
+    return pos < end ? pos : end;
+}
+
+// [from, end)에서 field 비트가 켜진 마지막 위치 (flip이 ~0이면 꺼진 위치, 없으면 end)
+inline size_t findLast(const ClassBlock* blocks, uint64_t ClassBlock::*field, uint64_t flip,
+                       size_t from, size_t end) {
+    if (from >= end) return end;
+    size_t b = (end - 1) / 64;
+    size_t first = from / 64;
+    uint64_t word = (blocks[b].*field ^ flip) & (~uint64_t(0) >> (63 - (end - 1) % 64));
+    while (word == 0) {
+        if (b == first) return end;
+        word = blocks[--b].*field ^ flip;
+    }
+    size_t pos = b * 64 + 63 - static_cast<size_t>(__builtin_clzll(word));
+    return pos >= from ? pos : end;
+}
+
+const uint64_t SET = 0;
+const uint64_t CLEAR = ~uint64_t(0);
+
+}  // namespace
+
+// ============================================================
+// 라인/필드 분리 (Parser::parseLine과 같은 규칙)
+// ============================================================
+size_t Scanner::scan(const char* data, size_t size, int& lineNum,
+                     std::vector<LineFields>& out, bool final) {
+    TRACE_SPAN("scan");
+    // 분류는 버퍼당 한 번, 이후 필드 경계는 비트마스크에서 찾음 (스레드마다 재사용)
+    thread_local std::vector<ClassBlock> classes;
+    classify(data, size, classes);
+    const ClassBlock* blocks = classes.data();
+
+    size_t pos = 0;
+    while (pos < size) {
+        size_t lineEnd = findNext(blocks, &ClassBlock::newline, SET, pos, size);
+        if (lineEnd == size && !final) {
+            break;  // 다음 버퍼와 이어지는 미완성 라인
+        }
+        size_t lineStart = pos;
+        pos = (lineEnd == size) ? size : lineEnd + 1;
+        lineNum++;
+
+        // 빈 줄, 주석 줄
+        if (lineEnd == lineStart || data[lineStart] == '#') continue;
+
+        // 라벨이 있는지 확인 (라인이 공백으로 시작하지 않으면 라벨)
+        bool hasLabel = !(data[lineStart] == ' ' || data[lineStart] == '\t');
+
+        size_t firstBegin = findNext(blocks, &ClassBlock::space, CLEAR, lineStart, lineEnd);
+        if (firstBegin == lineEnd) continue;  // 공백만 있는 줄
+        size_t firstEnd = findNext(blocks, &ClassBlock::space, SET, firstBegin, lineEnd);
+
+        LineFields fields;
+        fields.lineNum = lineNum;
+        size_t restBegin;
+        if (hasLabel) {
+            fields.labelBegin = firstBegin;
+            fields.labelEnd = firstEnd;
+            fields.opcodeBegin = findNext(blocks, &ClassBlock::space, CLEAR, firstEnd, lineEnd);
+            fields.opcodeEnd = findNext(blocks, &ClassBlock::space, SET, fields.opcodeBegin, lineEnd);
+            restBegin = fields.opcodeEnd;
+        } else {
+            fields.labelBegin = fields.labelEnd = lineStart;
+            fields.opcodeBegin = firstBegin;
+            fields.opcodeEnd = firstEnd;
+            restBegin = firstEnd;
+        }
+        if (fields.opcodeBegin == fields.opcodeEnd) continue;  // 라벨만 있는 줄
+
+        // 나머지는 operand (앞뒤 공백 제거)
+        fields.operandBegin = findNext(blocks, &ClassBlock::space, CLEAR, restBegin, lineEnd);
+        size_t lastChar = findLast(blocks, &ClassBlock::space, CLEAR, fields.operandBegin, lineEnd);
+        fields.operandEnd = (lastChar == lineEnd) ? fields.operandBegin : lastChar + 1;
+
+        // 피연산자 구분자 (C'..'/X'..' 따옴표, BUFFER,X / 레지스터 쌍의 쉼표)
+        fields.firstComma = findNext(blocks, &ClassBlock::comma, SET, fields.operandBegin, fields.operandEnd);
+        fields.firstQuote = findNext(blocks, &ClassBlock::quote, SET, fields.operandBegin, fields.operandEnd);
+        fields.lastQuote = findLast(blocks, &ClassBlock::quote, SET, fields.firstQuote, fields.operandEnd);
+        out.push_back(fields);
+    }
+    return pos;
+}
+
+SourceLine Scanner::toSourceLine(const char* data, const LineFields& fields) {
+    SourceLine result;
+    result.label.assign(data + fields.labelBegin, fields.labelEnd - fields.labelBegin);
+    result.opcode.assign(data + fields.opcodeBegin, fields.opcodeEnd - fields.opcodeBegin);
+    result.operand.assign(data + fields.operandBegin, fields.operandEnd - fields.operandBegin);
+    // 구분자 위치는 operand 기준으로 바꾸고, 없으면 find처럼 npos
+    auto relative = [&](size_t pos) {
+        return pos == fields.operandEnd ? std::string::npos : pos - fields.operandBegin;
+    };
+    result.comma = relative(fields.firstComma);
+    result.quote = relative(fields.firstQuote);
+    result.lastQuote = relative(fields.lastQuote);
+    return result;
+}
+
+const char* Scanner::simdLevel() {
+#if defined(__AVX2__)
+    return "AVX2";
+#elif defined(__SSE2__)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
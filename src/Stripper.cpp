@@ -0,0 +1,171 @@
+#include "../include/assembler.h"
+
+namespace {
+
+// 보고서에 자세히 보여 줄 제거 구간 수 (생성된 소스는 수만 개가 될 수 있음)
+const size_t REPORT_LIMIT = 50;
+
+// 구간에 속하는 라인 (주소가 있는 명령어와 데이터, START/USE/END와 EQU는 항상 남김)
+bool isLayoutLine(const IntermediateLine& line) {
+    return line.hasLocation && line.directive != Directive::START &&
+           line.directive != Directive::USE && line.directive != Directive::END;
+}
+
+}  // namespace
+
+Stripper::Stripper(OPTAB* opt, SYMTAB* sym, Pass1* p1)
+    : optab(opt), symtab(sym), pass1(p1), lengthBefore(0), lengthAfter(0) {}
+
+// ============================================================
+// 도달 가능성 분석 후 제거 (구간 나누기 -> 참조 그래프 -> 표시 -> 삭제 -> 주소 재배정)
+// ============================================================
+void Stripper::run() {
+    std::cout << "\n[Strip] Removing unreachable code and data..." << std::endl;
+    std::vector<IntermediateLine>& lines = pass1->getIntFile();
+    lengthBefore = pass1->getProgramLength();
+    int jId = optab->getId("J");
+    int rsubId = optab->getId("RSUB");
+
+    // 1. 구간 나누기: 블록마다 소스 순서로 라벨에서 새 구간 시작
+    std::vector<Region> regions;
+    std::vector<int> regionOf(lines.size(), -1);
+    std::vector<int> symbolRegion(symtab->size(), -1);  // 라벨 심볼 -> 정의한 구간 (첫 정의)
+    std::vector<int> current(pass1->getBlockCount(), -1);
+    std::vector<bool> lastFallsThrough;
+    int firstRegion = -1;
+    for (size_t k = 0; k < lines.size(); ++k) {
+        const IntermediateLine& line = lines[k];
+        if (!isLayoutLine(line)) continue;
+        int& open = current[line.block];
+        if (!line.label.empty() || open < 0) {
+            int id = line.label.empty() ? -1 : symtab->intern(line.label);
+            int r = static_cast<int>(regions.size());
+            regions.push_back({id, -1, true, false});
+            lastFallsThrough.push_back(true);
+            if (open >= 0) regions[open].next = r;
+            if (id >= 0 && id < static_cast<int>(symbolRegion.size()) && symbolRegion[id] < 0) {
+                symbolRegion[id] = r;
+            }
+            if (firstRegion < 0) firstRegion = r;
+            open = r;
+        }
+        regionOf[k] = open;
+        // 길이 0인 라인(RESB 0 등)은 별칭일 뿐이므로 이어짐 여부를 바꾸지 않음
+        if (line.length > 0) {
+            bool isCode = line.parsed.opId >= 0;
+            regions[open].hasCode = regions[open].hasCode || isCode;
+            lastFallsThrough[open] = isCode && line.parsed.opId != jId && line.parsed.opId != rsubId;
+        }
+    }
+    for (size_t r = 0; r < regions.size(); ++r) {
+        regions[r].fallsThrough = lastFallsThrough[r];
+    }
+
+    // 2. 참조 그래프 (구간 -> 참조한 심볼의 구간), 구간별로 모은 CSR 형태
+    //    인덱스 참조(,X)는 표 뒤에 이어진 데이터 구간까지 읽을 수 있으므로 따로 표시
+    std::vector<int> edgeStart(regions.size() + 1, 0);
+    auto targetOf = [&](const IntermediateLine& line) {
+        int id = line.parsed.symId;
+        return (id >= 0 && id < static_cast<int>(symbolRegion.size())) ? symbolRegion[id] : -1;
+    };
+    for (size_t k = 0; k < lines.size(); ++k) {
+        if (regionOf[k] >= 0 && targetOf(lines[k]) >= 0) edgeStart[regionOf[k] + 1]++;
+    }
+    for (size_t r = 0; r < regions.size(); ++r) {
+        edgeStart[r + 1] += edgeStart[r];
+    }
+    std::vector<std::pair<int, bool>> edges(static_cast<size_t>(edgeStart.back()));
+    std::vector<int> fill(edgeStart.begin(), edgeStart.end() - 1);
+    for (size_t k = 0; k < lines.size(); ++k) {
+        int target = regionOf[k] >= 0 ? targetOf(lines[k]) : -1;
+        if (target >= 0) edges[fill[regionOf[k]]++] = {target, lines[k].parsed.indexed};
+    }
+
+    // 3. 표시: END의 시작 심볼(없으면 첫 구간)과 라벨 없는 구간에서 출발
+    std::vector<bool> reached(regions.size(), false);
+    std::vector<int> stack;
+    auto visit = [&](int r) {
+        if (r >= 0 && !reached[r]) {
+            reached[r] = true;
+            stack.push_back(r);
+        }
+    };
+    int entry = -1;
+    for (const auto& line : lines) {
+        if (line.directive == Directive::END) {
+            entry = targetOf(line);
+            break;
+        }
+    }
+    visit(entry >= 0 ? entry : firstRegion);
+    for (size_t r = 0; r < regions.size(); ++r) {
+        if (regions[r].labelId < 0) visit(static_cast<int>(r));
+    }
+    while (!stack.empty()) {
+        int r = stack.back();
+        stack.pop_back();
+        if (regions[r].fallsThrough) visit(regions[r].next);
+        for (int e = edgeStart[r]; e < edgeStart[r + 1]; ++e) {
+            visit(edges[e].first);
+            if (!edges[e].second) continue;
+            for (int t = regions[edges[e].first].next; t >= 0 && !regions[t].hasCode;
+                 t = regions[t].next) {
+                visit(t);
+            }
+        }
+    }
+
+    // 4. 도달하지 못한 구간의 라인 삭제, 라벨은 미정의로 되돌림
+    std::vector<int> reportIndex(regions.size(), -1);
+    std::vector<IntermediateLine> kept;
+    kept.reserve(lines.size());
+    for (size_t k = 0; k < lines.size(); ++k) {
+        int r = regionOf[k];
+        if (r < 0 || reached[r]) {
+            kept.push_back(std::move(lines[k]));
+            continue;
+        }
+        if (reportIndex[r] < 0) {
+            reportIndex[r] = static_cast<int>(removed.size());
+            removed.push_back({lines[k].label, lines[k].location, 0, 0});
+            symtab->undefine(regions[r].labelId);
+        }
+        removed[reportIndex[r]].lines++;
+        removed[reportIndex[r]].bytes += lines[k].length;
+    }
+    lines.swap(kept);
+    if (!removed.empty()) {
+        pass1->relayout();
+    }
+
+    lengthAfter = pass1->getProgramLength();
+    std::cout << "Strip completed: " << removed.size() << " of " << regions.size()
+              << " regions removed, " << lengthBefore - lengthAfter << " bytes saved" << std::endl;
+}
+
+void Stripper::printReport() const {
+    std::cout << "\n" << std::string(80, '=') << std::endl;
+    std::cout << "STRIP REPORT (unreachable labels)" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << std::left << std::setw(10) << "LOC"
+              << std::setw(20) << "Label"
+              << std::setw(10) << "Lines"
+              << "Bytes" << std::endl;
+    std::cout << std::string(80, '-') << std::endl;
+    for (size_t k = 0; k < removed.size() && k < REPORT_LIMIT; ++k) {
+        const StrippedRegion& region = removed[k];
+        std::cout << "0x" << std::right << std::hex << std::uppercase << std::setfill('0')
+                  << std::setw(6) << region.location << "  "
+                  << std::left << std::dec << std::setfill(' ')
+                  << std::setw(20) << region.label
+                  << std::setw(10) << region.lines
+                  << region.bytes << std::endl;
+    }
+    if (removed.size() > REPORT_LIMIT) {
+        std::cout << "... " << removed.size() - REPORT_LIMIT << " more" << std::endl;
+    }
+    std::cout << std::string(80, '-') << std::endl;
+    std::cout << "Program length: " << lengthBefore << " -> " << lengthAfter << " bytes ("
+              << lengthBefore - lengthAfter << " saved)" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+}
@@ -0,0 +1,136 @@
+#include "../include/assembler.h"
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+SymbolSnapshot::SymbolSnapshot()
+    : base(nullptr), mappedSize(0), header(nullptr), entries(nullptr),
+      hashIndex(nullptr), strings(nullptr) {}
+
+SymbolSnapshot::~SymbolSnapshot() {
+    if (base != nullptr) {
+        munmap(const_cast<unsigned char*>(base), mappedSize);
+    }
+}
+
+// FNV-1a 32-bit
+uint32_t SymbolSnapshot::hashName(const char* name, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t k = 0; k < length; ++k) {
+        hash ^= static_cast<unsigned char>(name[k]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool SymbolSnapshot::isSnapshotFile(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[4] = {0, 0, 0, 0};
+    file.read(magic, 4);
+    return file && std::memcmp(magic, "SYMB", 4) == 0;
+}
+
+bool SymbolSnapshot::open(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open symbol snapshot: " << filename << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+        std::cerr << "Error: Invalid symbol snapshot: " << filename << std::endl;
+        ::close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Cannot map symbol snapshot: " << filename << std::endl;
+        return false;
+    }
+
+    base = static_cast<const unsigned char*>(mapped);
+    mappedSize = size;
+    header = reinterpret_cast<const Header*>(base);
+
+    // 각 구역의 크기가 파일 크기와 맞는지 확인
+    size_t entriesBytes = static_cast<size_t>(header->count) * sizeof(Entry);
+    size_t hashBytes = static_cast<size_t>(header->hashSize) * sizeof(uint32_t);
+    bool valid = std::memcmp(header->magic, "SYMB", 4) == 0 &&
+                 header->version == VERSION &&
+                 header->hashSize != 0 && (header->hashSize & (header->hashSize - 1)) == 0 &&
+                 header->hashSize > header->count &&
+                 sizeof(Header) + entriesBytes + hashBytes + header->stringBytes == size;
+    if (!valid) {
+        std::cerr << "Error: Invalid symbol snapshot: " << filename << std::endl;
+        munmap(mapped, size);
+        base = nullptr;
+        header = nullptr;
+        return false;
+    }
+
+    entries = reinterpret_cast<const Entry*>(base + sizeof(Header));
+    hashIndex = reinterpret_cast<const uint32_t*>(base + sizeof(Header) + entriesBytes);
+    strings = reinterpret_cast<const char*>(base + sizeof(Header) + entriesBytes + hashBytes);
+
+    // 조회 때는 다시 확인하지 않으므로 여기서 한 번에 검사
+    // (이름은 NUL 종료를 포함해 문자열 블록 안, 해시 색인은 0 또는 엔트리 번호 + 1)
+    bool intact = true;
+    for (uint32_t k = 0; k < header->count && intact; ++k) {
+        intact = static_cast<size_t>(entries[k].nameOffset) + entries[k].nameLength < header->stringBytes;
+    }
+    for (uint32_t slot = 0; slot < header->hashSize && intact; ++slot) {
+        intact = hashIndex[slot] <= header->count;
+    }
+    if (!intact) {
+        std::cerr << "Error: Corrupt symbol snapshot: " << filename << std::endl;
+        munmap(mapped, size);
+        base = nullptr;
+        header = nullptr;
+        return false;
+    }
+    return true;
+}
+
+int SymbolSnapshot::size() const {
+    return header != nullptr ? static_cast<int>(header->count) : 0;
+}
+
+const SymbolSnapshot::Entry& SymbolSnapshot::entry(int index) const {
+    return entries[index];
+}
+
+std::string SymbolSnapshot::nameOf(const Entry& e) const {
+    return std::string(strings + e.nameOffset, e.nameLength);
+}
+
+// 해시 색인 (선형 탐사)
+int SymbolSnapshot::find(const std::string& name) const {
+    if (header == nullptr) return -1;
+    uint32_t mask = header->hashSize - 1;
+    uint32_t slot = hashName(name.data(), name.size()) & mask;
+    for (uint32_t probe = 0; probe < header->hashSize; ++probe) {
+        uint32_t index = hashIndex[slot];
+        if (index == 0) return -1;
+        const Entry& e = entries[index - 1];
+        if (e.nameLength == name.size() && std::memcmp(strings + e.nameOffset, name.data(), name.size()) == 0) {
+            return static_cast<int>(index - 1);
+        }
+        slot = (slot + 1) & mask;
+    }
+    return -1;
+}
+
+// 주소순 배열 이진 탐색
+int SymbolSnapshot::findByAddress(int address) const {
+    if (header == nullptr || address < 0) return -1;
+    const Entry* first = entries;
+    const Entry* last = entries + header->count;
+    const Entry* it = std::lower_bound(first, last, static_cast<uint32_t>(address),
+                                       [](const Entry& e, uint32_t addr) { return e.address < addr; });
+    if (it == last || it->address != static_cast<uint32_t>(address)) return -1;
+    return static_cast<int>(it - first);
+}
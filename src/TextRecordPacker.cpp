@@ -0,0 +1,191 @@
+#include "../include/assembler.h"
+
+namespace {
+
+void appendHex(std::string& out, int value, int width) {
+    static const char digits[] = "0123456789ABCDEF";
+    for (int k = width - 1; k >= 0; --k) {
+        out += digits[(value >> (k * 4)) & 0xF];
+    }
+}
+
+// F 레코드가 펼친 데이터보다 짧을 때만 사용: F[주소(6)][반복 수(6)][패턴 길이(2)] = 15글자,
+// 그리고 이어지던 T 레코드가 끊기면 새 T 헤더(9글자)가 더 생김
+const int FILL_RECORD_OVERHEAD = 15 + 9;
+const int FILL_MAX_PATTERN = 0xFF;
+const int FILL_MAX_COUNT = 0xFFFFFF;
+
+}  // namespace
+
+TextRecordPacker::TextRecordPacker(const TextRecordOptions& opts)
+    : options(opts), sink(nullptr), recordCount(0), currentStart(0), currentLength(0),
+      totalBytes(0), splitCount(0), gapBytes(0), fillCount(0), fillBytes(0) {}
+
+void TextRecordPacker::start(int loc) {
+    flush();
+    currentStart = loc;
+    currentLength = 0;
+    current = "T";
+    appendHex(current, loc, 6);
+}
+
+void TextRecordPacker::flush() {
+    if (currentLength > 0) {
+        TRACE_SPAN("T record");
+        // T[주소(6)][길이(2)][코드...]
+        std::string length;
+        appendHex(length, currentLength, 2);
+        current.insert(7, length);
+        write(current);
+        recordCount++;
+    }
+    current.clear();
+    currentLength = 0;
+    currentStart = 0;
+}
+
+void TextRecordPacker::write(const std::string& record) {
+    if (sink != nullptr) {
+        *sink << record << '\n';
+    } else {
+        records.push_back(record);
+    }
+}
+
+// 열린 레코드 끝과 loc 사이가 떨어져 있으면 좁은 틈은 00으로 채우고, 아니면 레코드를 닫음
+// (need: 틈을 채운 뒤 같은 레코드에 들어가야 하는 최소 바이트 수)
+void TextRecordPacker::bridge(int loc, int need) {
+    if (current.empty()) {
+        return;
+    }
+    int gap = loc - (currentStart + currentLength);
+    if (gap > 0 && gap <= options.gapFill && currentLength + gap + need <= options.maxLength) {
+        current.append(static_cast<size_t>(gap) * 2, '0');
+        currentLength += gap;
+        gapBytes += gap;
+        gap = 0;
+    }
+    if (gap != 0) {
+        flush();
+    }
+}
+
+// ============================================================
+// 목적 코드 추가
+// ============================================================
+void TextRecordPacker::append(const std::string& objCode, int loc, bool isData) {
+    int codeBytes = static_cast<int>(objCode.length() / 2);
+    if (codeBytes == 0) {
+        return;  // RESW/RESB: 다음 코드의 주소가 불연속이면 그때 새 레코드가 시작됨
+    }
+    totalBytes += codeBytes;
+
+    // 최대 길이보다 긴 코드는 설정과 무관하게 나눠야 함
+    bool splittable = (isData && options.splitData) || codeBytes > options.maxLength;
+
+    // 틈을 채운 뒤에도 코드가 (분할 가능하면 1바이트라도) 들어갈 때만 채움
+    bridge(loc, splittable ? 1 : codeBytes);
+
+    int pos = 0;
+    while (pos < codeBytes) {
+        if (current.empty()) {
+            start(loc + pos);
+        }
+        int room = options.maxLength - currentLength;
+        int remaining = codeBytes - pos;
+        if (remaining <= room) {
+            current.append(objCode, static_cast<size_t>(pos) * 2, static_cast<size_t>(remaining) * 2);
+            currentLength += remaining;
+            break;
+        }
+        if (splittable && room > 0) {
+            // 남은 칸만큼 채우고 나머지는 다음 레코드로
+            current.append(objCode, static_cast<size_t>(pos) * 2, static_cast<size_t>(room) * 2);
+            currentLength += room;
+            pos += room;
+            splitCount++;
+        }
+        flush();
+    }
+}
+
+// ============================================================
+// 반복 데이터 추가 (FILL): 레코드 단위로 패턴을 이어 붙임, 압축 가능하면 F 레코드 하나
+// ============================================================
+void TextRecordPacker::appendRun(const std::string& pattern, int count, int loc) {
+    int patternBytes = static_cast<int>(pattern.size());
+    int length = patternBytes * count;
+    if (length == 0) {
+        return;
+    }
+    std::string patternHex;
+    for (char c : pattern) {
+        appendHex(patternHex, static_cast<unsigned char>(c), 2);
+    }
+
+    if (options.fillRecords && patternBytes <= FILL_MAX_PATTERN && count <= FILL_MAX_COUNT &&
+        length * 2 > patternBytes * 2 + FILL_RECORD_OVERHEAD) {
+        // F[주소(6)][반복 수(6)][패턴 길이(2)][패턴...]
+        flush();
+        std::string record = "F";
+        appendHex(record, loc, 6);
+        appendHex(record, count, 6);
+        appendHex(record, patternBytes, 2);
+        record += patternHex;
+        write(record);
+        fillCount++;
+        fillBytes += length;
+        return;
+    }
+
+    totalBytes += length;
+    bridge(loc, 1);  // 반복 데이터는 항상 레코드 경계에서 나눌 수 있음
+    int pos = 0;
+    while (true) {
+        if (current.empty()) {
+            start(loc + pos);
+        }
+        int take = std::min(options.maxLength - currentLength, length - pos);
+        for (int k = 0; k < take; ++k) {
+            current.append(patternHex, static_cast<size_t>((pos + k) % patternBytes) * 2, 2);
+        }
+        currentLength += take;
+        pos += take;
+        if (pos == length) {
+            break;
+        }
+        // 열린 레코드가 이미 가득 차서 한 바이트도 넣지 못했으면 경계를 넘은 것이 아님
+        if (take > 0) {
+            splitCount++;
+        }
+        flush();
+    }
+}
+
+void TextRecordPacker::setSink(std::ostream* out) {
+    sink = out;
+}
+
+void TextRecordPacker::finish() {
+    flush();
+}
+
+const std::vector<std::string>& TextRecordPacker::getRecords() const {
+    return records;
+}
+
+void TextRecordPacker::printSummary(std::ostream& out) const {
+    size_t count = recordCount;
+    double average = count > 0 ? static_cast<double>(totalBytes + gapBytes) / count : 0.0;
+    out << "\nT records: " << count
+        << " (max " << options.maxLength << " bytes, avg "
+        << std::fixed << std::setprecision(1) << average << std::defaultfloat
+        << " bytes/record)" << std::endl;
+    out << "  code bytes: " << totalBytes
+        << ", split across records: " << splitCount
+        << ", gap bytes filled: " << gapBytes << std::endl;
+    if (fillCount > 0) {
+        out << "F records: " << fillCount << " (" << fillBytes << " bytes of repeated data)"
+            << std::endl;
+    }
+}
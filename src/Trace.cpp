@@ -0,0 +1,100 @@
+#include "../include/assembler.h"
+
+#ifdef ASM_TRACE
+
+#include <mutex>
+#include <set>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    Trace::Clock::time_point begin;
+    Trace::Clock::time_point end;
+};
+
+// 스레드마다 하나, 해당 스레드만 추가하므로 잠금 불필요
+// (스레드가 끝난 뒤에도 출력할 수 있도록 해제하지 않음)
+struct ThreadBuffer {
+    int tid;
+    std::vector<TraceEvent> events;
+    ThreadBuffer* next;
+};
+
+std::atomic<ThreadBuffer*> g_buffers(nullptr);
+std::atomic<int> g_nextTid(1);
+const Trace::Clock::time_point g_epoch = Trace::Clock::now();
+
+ThreadBuffer* threadBuffer() {
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (buffer == nullptr) {
+        buffer = new ThreadBuffer();
+        buffer->tid = g_nextTid.fetch_add(1, std::memory_order_relaxed);
+        buffer->events.reserve(4096);
+        // 전역 목록 앞에 CAS로 연결
+        buffer->next = g_buffers.load(std::memory_order_relaxed);
+        while (!g_buffers.compare_exchange_weak(buffer->next, buffer, std::memory_order_release,
+                                                std::memory_order_relaxed)) {
+        }
+    }
+    return buffer;
+}
+
+double micros(Trace::Clock::time_point t) {
+    return std::chrono::duration<double, std::micro>(t - g_epoch).count();
+}
+
+void writeEscaped(std::ostream& out, const char* str) {
+    for (const char* p = str; *p != '\0'; ++p) {
+        if (*p == '"' || *p == '\\') out << '\\';
+        out << *p;
+    }
+}
+
+}  // namespace
+
+void Trace::record(const char* name, Clock::time_point begin, Clock::time_point end) {
+    threadBuffer()->events.push_back({name, begin, end});
+}
+
+const char* Trace::intern(const std::string& name) {
+    static std::mutex mutex;
+    static std::set<std::string> names;
+    std::lock_guard<std::mutex> lock(mutex);
+    return names.insert(name).first->c_str();
+}
+
+// ============================================================
+// Chrome trace JSON 출력 (완료 이벤트 "X", 시간 단위 us)
+// ============================================================
+bool Trace::writeJson(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot write trace file: " << filename << std::endl;
+        return false;
+    }
+
+    file << "{\"traceEvents\":[\n";
+    file << std::fixed << std::setprecision(3);
+    bool first = true;
+    size_t count = 0;
+    for (ThreadBuffer* buffer = g_buffers.load(std::memory_order_acquire); buffer != nullptr;
+         buffer = buffer->next) {
+        for (const TraceEvent& e : buffer->events) {
+            if (!first) file << ",\n";
+            first = false;
+            file << "{\"name\":\"";
+            writeEscaped(file, e.name);
+            file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid
+                 << ",\"ts\":" << micros(e.begin)
+                 << ",\"dur\":" << micros(e.end) - micros(e.begin) << "}";
+            count++;
+        }
+    }
+    file << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    file.close();
+    std::cout << "Trace written: " << filename << " (" << count << " spans)" << std::endl;
+    return true;
+}
+
+#endif
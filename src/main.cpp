@@ -1,81 +1,734 @@
 // ========== src/main.cpp (수정) ==========
 #include "../include/assembler.h"
+#include <cstdio>
+#include <sys/stat.h>
 
-int main() {
-    std::cout << "\n" << std::string(70, '=') << std::endl;
-    std::cout << "           SIC/XE ASSEMBLER" << std::endl;
-    std::cout << std::string(70, '=') << std::endl;
-    
-    // ==================================================
-    // 1. OPTAB 로드
-    // ==================================================
-    std::cout << "\n[Step 1] Loading OPTAB..." << std::endl;
-    OPTAB optab;
-    if (!optab.load("input/optab.txt")) {
-        std::cerr << "Failed to load OPTAB. Exiting..." << std::endl;
+namespace {
+
+// 조립 한 번에 필요한 옵션
+struct AssembleOptions {
+    int loadAddr = -1;       // --load <hex>: 조립 후 해당 주소로 재배치 적재
+    bool packRes = false;    // --pack-res: RESW/RESB를 마지막 블록으로 모음
+    bool profile = false;    // --profile: 단계별 시간/할당 통계 출력
+    bool pipeline = false;   // --pipeline: 읽기/파싱/Pass1 병렬, 파일 출력은 백그라운드
+    bool symtabBin = false;  // --symtab-bin: 바이너리 심볼 스냅샷(output/SYMTAB.bin)도 출력
+    std::string importSymbols;   // --import-symbols <file>: 스냅샷을 읽기 전용 계층으로 연결
+    std::string preloadSymbols;  // --preload-symbols <file>: 스냅샷 심볼을 미리 삽입
+    bool outOfCore = false;  // --out-of-core: 중간파일을 바이너리로 디스크에 두고 Pass2는 mmap으로 읽음
+    bool pass2Only = false;  // --pass2-only: 이전 --out-of-core 실행의 중간파일과 SYMTAB.bin으로 Pass2만 실행
+    bool lineMapOut = false; // --line-map: 주소 -> 소스 라인 표(output/LINEMAP.bin)도 출력
+    bool optimize = false;   // --optimize: Pass1과 Pass2 사이에 peephole 최적화
+    bool strip = false;      // --strip: END의 시작 심볼에서 도달할 수 없는 라벨 구간 제거
+    bool image = false;      // --image: 평면 메모리 이미지(output/IMGFILE + IMGFILE.hdr)도 출력
+    int maxErrors = 100;     // --max-errors <n>: 오류가 n개 쌓이면 중단 (0이면 제한 없음)
+    bool diagJson = false;   // --diag-json: 진단을 output/DIAGNOSTICS.json으로도 출력
+    TextRecordOptions trecOptions;  // --trec-max <n> / --trec-split / --trec-gap <n> / --trec-fill: T 레코드 묶기
+    bool check = false;      // --check: Pass1과 심볼/변위 검사만, 목적 코드와 파일 출력 없음
+    bool quiet = false;      // 리스팅/오브젝트 프로그램 화면 출력 생략 (--watch)
+    bool keepUnchanged = false;  // 내용이 같은 출력 파일은 다시 쓰지 않음 (--watch)
+    std::string cacheDir;    // --cache <dir>: 같은 입력이면 저장된 출력을 복원하고 Pass1/Pass2 생략
+    uint64_t cacheMaxBytes = 256ULL << 20;  // --cache-max <MB>: 캐시 크기 제한 (LRU로 정리)
+};
+
+// 출력 파일을 "이름.new"로 쓰게 한 뒤 commit에서 내용이 바뀐 것만 교체
+// (내용이 같으면 기존 파일과 수정 시각을 그대로 둠, commit 없이 끝나면 이전 출력 유지)
+// 스테이징을 끄면 경로는 그대로 두고 이번 실행의 출력 목록만 기록 (캐시 저장용)
+class OutputFiles {
+private:
+    bool staging;
+    std::vector<std::string> staged;
+
+    static bool sameContents(const std::string& a, const std::string& b) {
+        std::ifstream fa(a, std::ios::binary);
+        std::ifstream fb(b, std::ios::binary);
+        if (!fa.is_open() || !fb.is_open()) return false;
+        std::vector<char> bufA(1 << 16), bufB(1 << 16);
+        while (true) {
+            fa.read(bufA.data(), bufA.size());
+            fb.read(bufB.data(), bufB.size());
+            if (fa.gcount() != fb.gcount()) return false;
+            if (!std::equal(bufA.begin(), bufA.begin() + fa.gcount(), bufB.begin())) return false;
+            if (!fa || !fb) return !fa && !fb;
+        }
+    }
+
+public:
+    explicit OutputFiles(bool enable) : staging(enable) {}
+    ~OutputFiles() {
+        for (const auto& filename : staged) {
+            std::remove((filename + ".new").c_str());
+        }
+    }
+
+    std::string path(const std::string& filename) {
+        if (std::find(staged.begin(), staged.end(), filename) == staged.end()) {
+            staged.push_back(filename);
+        }
+        return staging ? filename + ".new" : filename;
+    }
+
+    const std::vector<std::string>& files() const { return staged; }
+
+    void commit() {
+        if (!staging) {
+            staged.clear();
+            return;
+        }
+        int changed = 0;
+        for (const auto& filename : staged) {
+            std::string temp = filename + ".new";
+            std::ifstream exists(temp);
+            if (!exists.is_open()) continue;  // 이번 실행에서 쓰지 않음
+            exists.close();
+            if (sameContents(temp, filename)) {
+                std::remove(temp.c_str());
+            } else {
+                std::rename(temp.c_str(), filename.c_str());
+                changed++;
+            }
+        }
+        std::cout << "Output files updated: " << changed << " of " << staged.size() << std::endl;
+        staged.clear();
+    }
+};
+
+// 소스가 실제로 바뀌었는지 판단하기 위한 내용 지문 (크기 + FNV-1a)
+std::pair<uint64_t, uint64_t> fingerprint(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    uint64_t hash = 14695981039346656037ULL;
+    uint64_t size = 0;
+    std::vector<char> buffer(1 << 20);
+    while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+        std::streamsize count = file.gcount();
+        for (std::streamsize k = 0; k < count; ++k) {
+            hash = (hash ^ static_cast<unsigned char>(buffer[k])) * 1099511628211ULL;
+        }
+        size += static_cast<uint64_t>(count);
+    }
+    return {size, hash};
+}
+
+// 캐시 키: 출력을 결정하는 입력 전부 (소스, 불러온 OPTAB, 심볼 스냅샷, 출력 옵션, 어셈블러 실행 파일)
+// (include 지시어가 없으므로 소스는 파일 하나, OPTAB은 파일 대신 메모리의 표를 해시: 감시 모드에서
+//  다시 읽기에 실패해 이전 표를 쓰는 경우도 맞게 구분)
+std::string cacheKey(const OPTAB& optab, const std::string& srcFilename, const AssembleOptions& opts) {
+    ContentHash hash;
+    hash.updateString("SIC/XE assembly cache v1");
+    struct stat exe;
+    if (::stat("/proc/self/exe", &exe) == 0) {
+        int64_t stamp[3] = {static_cast<int64_t>(exe.st_size), exe.st_mtim.tv_sec,
+                            exe.st_mtim.tv_nsec};
+        hash.update(stamp, sizeof(stamp));
+    }
+    if (!hash.updateFile(srcFilename)) return "";
+    for (int id = 0; id < optab.size(); ++id) {
+        const InstructionInfo& info = optab.getInfo(id);
+        hash.updateString(info.mnemonic);
+        hash.update(&info.opcodeValue, sizeof(info.opcodeValue));
+        hash.update(&info.format, sizeof(info.format));
+    }
+    for (const std::string* snapshot : {&opts.preloadSymbols, &opts.importSymbols}) {
+        hash.updateString(*snapshot);
+        if (!snapshot->empty() && !hash.updateFile(*snapshot)) return "";
+    }
+    std::ostringstream flags;
+    flags << opts.packRes << opts.symtabBin << opts.outOfCore << opts.lineMapOut << opts.optimize
+          << opts.strip << opts.image << ' ' << opts.trecOptions.maxLength << ' '
+          << opts.trecOptions.splitData << ' ' << opts.trecOptions.gapFill << ' '
+          << opts.trecOptions.fillRecords;
+    hash.updateString(flags.str());
+    return hash.hex();
+}
+
+// Step 6: OBJFILE을 지정한 주소로 재배치 적재하고 메모리 덤프
+bool loadProgram(const std::string& objPath, int loadAddr, Profiler& profiler) {
+    profiler.begin("load");
+    std::cout << "\n[Step 6] Loading object program at 0x" << std::hex << std::uppercase
+              << loadAddr << std::dec << "..." << std::endl;
+    Loader loader;
+    if (!loader.load(objPath, loadAddr)) {
+        std::cerr << "Load failed. Exiting..." << std::endl;
+        return false;
+    }
+    std::cout << "Entry point: 0x" << std::hex << std::uppercase
+              << loader.getEntryPoint() << std::dec << std::endl;
+    loader.dumpMemory(loadAddr, loader.getProgramLength());
+    return true;
+}
+
+// ==================================================
+// 검사만 (--check): 진단 외에는 아무것도 쓰지 않음, 종료 코드 반환
+// ==================================================
+int checkFile(OPTAB& optab, const std::string& srcFilename, const AssembleOptions& opts) {
+    Diagnostics::reset();
+    Diagnostics::setSourceFile(srcFilename);
+    Diagnostics::setMaxErrors(opts.maxErrors);
+
+    SYMTAB symtab;
+    if (!opts.preloadSymbols.empty() && !symtab.loadSnapshot(opts.preloadSymbols, false)) {
+        return 1;
+    }
+    if (!opts.importSymbols.empty() && !symtab.loadSnapshot(opts.importSymbols, true)) {
         return 1;
     }
-    
+
+    Pass1 pass1(&optab, &symtab);
+    pass1.setPackReservations(opts.packRes);
+    bool ok = opts.pipeline ? pass1.executePipelined(srcFilename) : pass1.execute(srcFilename);
+    if (ok) {
+        Pass2 pass2(&optab, &symtab, pass1.getIntFile(), pass1.getStartAddress(),
+                    pass1.getProgramLength(), pass1.getProgramName());
+        ok = pass2.check();
+    }
+
+    Diagnostics::flush(std::cerr);
+    if (opts.diagJson) {
+        Diagnostics::writeJson("output/DIAGNOSTICS.json");
+    }
+    std::cout << srcFilename << ": " << (ok ? "OK" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
+
+// ==================================================
+// 조립 한 번 (SYMTAB 생성부터 적재까지), 종료 코드 반환
+// ==================================================
+int assembleFile(OPTAB& optab, const std::string& srcFilename, const AssembleOptions& opts,
+                 Profiler& profiler, AssemblyCache* cache) {
+    Diagnostics::reset();
+    Diagnostics::setSourceFile(srcFilename);
+    Diagnostics::setMaxErrors(opts.maxErrors);
+    OutputFiles outputs(opts.keepUnchanged);
+
+    // 캐시 적중: 저장된 출력 파일과 리스팅을 복원하고 Pass 1/Pass 2를 건너뜀
+    std::string key;
+    if (cache != nullptr) {
+        profiler.begin("cache");
+        key = cacheKey(optab, srcFilename, opts);
+        std::string listing;
+        if (!key.empty() &&
+            cache->lookup(key, listing,
+                          [&outputs](const std::string& name) { return outputs.path(name); })) {
+            std::cout << "\n[Cache] Hit " << key << ", Pass 1 and Pass 2 skipped" << std::endl;
+            if (!opts.quiet) {
+                std::cout << listing;
+            }
+            if (opts.diagJson) {
+                Diagnostics::writeJson("output/DIAGNOSTICS.json");
+            }
+            size_t restored = outputs.files().size();
+            outputs.commit();
+            if (opts.loadAddr >= 0 && !loadProgram("output/OBJFILE", opts.loadAddr, profiler)) {
+                return 1;
+            }
+            profiler.end();
+            std::cout << "\n✓ Output files restored from cache (" << restored << " files)"
+                      << std::endl;
+            if (opts.profile) {
+                profiler.report();
+            }
+            return 0;
+        }
+        std::cout << "\n[Cache] Miss " << key << std::endl;
+    }
+
+    // 진단은 모아 두었다가 단계가 끝날 때 한 번에 출력 (실패해도 항상 갱신)
+    auto flushDiagnostics = [&opts]() {
+        Diagnostics::flush(std::cerr);
+        if (opts.diagJson) {
+            Diagnostics::writeJson("output/DIAGNOSTICS.json");
+        }
+    };
+    bool outOfCore = opts.outOfCore;
+    bool pass2Only = opts.pass2Only;
+
     // ==================================================
     // 2. SYMTAB 생성
     // ==================================================
     std::cout << "\n[Step 2] Initializing SYMTAB..." << std::endl;
     SYMTAB symtab;
+    if (!opts.preloadSymbols.empty() && !symtab.loadSnapshot(opts.preloadSymbols, false)) {
+        return 1;
+    }
+    if (!opts.importSymbols.empty() && !symtab.loadSnapshot(opts.importSymbols, true)) {
+        return 1;
+    }
     std::cout << "SYMTAB initialized successfully" << std::endl;
-    
+
     // ==================================================
     // 3. Pass 1 실행
     // ==================================================
-    std::cout << "\n[Step 3] Running Pass 1..." << std::endl;
     Pass1 pass1(&optab, &symtab);
-    
-    if (!pass1.execute("input/SRCFILE")) {
-        std::cerr << "Pass 1 failed. Exiting..." << std::endl;
-        return 1;
+    IntermediateWriter spill;
+
+    // 파이프라인 모드에서는 파일 출력을 백그라운드 스레드로 넘겨 Pass 2와 겹침
+    std::unique_ptr<AsyncWriter> writer;
+    auto output = [&writer](std::function<void()> task) {
+        if (writer) writer->submit(task);
+        else task();
+    };
+
+    // --pass2-only는 이전 실행의 중간파일을 그대로 읽음
+    std::string intRecords = "output/INTFILE.bin";
+    std::string intStrings = "output/INTFILE.str";
+    if (outOfCore && !pass2Only) {
+        intRecords = outputs.path(intRecords);
+        intStrings = outputs.path(intStrings);
+    }
+
+    if (!pass2Only) {
+        std::cout << "\n[Step 3] Running Pass 1..." << std::endl;
+        pass1.setPackReservations(opts.packRes);
+        if (opts.profile) {
+            pass1.setProfiler(&profiler);  // 라인마다 parse/Pass1 단계를 나눠서 측정
+        }
+        if (outOfCore) {
+            if (!spill.open(intRecords, intStrings)) {
+                return 1;
+            }
+            pass1.setSpill(&spill);  // 중간파일을 메모리에 두지 않음
+        }
+
+        profiler.begin("Pass1");
+        bool pass1Ok = opts.pipeline ? pass1.executePipelined(srcFilename)
+                                     : pass1.execute(srcFilename);
+        flushDiagnostics();
+        if (!pass1Ok) {
+            std::cerr << "Pass 1 failed. Exiting..." << std::endl;
+            return 1;
+        }
+
+        // 주소와 라벨이 바뀔 수 있으므로 파일 출력보다 먼저 실행
+        if (opts.optimize) {
+            profiler.begin("optimize");
+            Optimizer optimizer(&optab, &symtab, &pass1);
+            optimizer.run();
+            optimizer.printReport();
+        }
+        // 최적화가 점프 체인을 줄이면 중간 점프만 있던 구간도 지울 수 있으므로 그 뒤에 실행
+        if (opts.strip) {
+            profiler.begin("strip");
+            Stripper stripper(&optab, &symtab, &pass1);
+            stripper.run();
+            stripper.printReport();
+        }
+
+        if (pass1.getBlockCount() > 1) {
+            pass1.printBlockTable();
+        }
+
+        if (opts.pipeline) {
+            writer.reset(new AsyncWriter());
+        }
+
+        // Pass 1 결과 (중간파일) 저장
+        profiler.begin("output");
+        if (!outOfCore) {
+            std::string path = outputs.path("output/INTFILE");
+            output([&pass1, path]() { pass1.writeIntFile(path); });
+        }
+        // SYMTAB 파일 저장 (중간파일 모드에서는 --pass2-only용 스냅샷도 항상 저장)
+        std::string symtabPath = outputs.path("output/SYMTAB.txt");
+        output([&symtab, symtabPath]() { symtab.writeToFile(symtabPath); });
+        if (opts.symtabBin || outOfCore) {
+            std::string path = outputs.path("output/SYMTAB.bin");
+            output([&symtab, path]() { symtab.writeSnapshot(path); });
+        }
+        std::cout << "Pass 1 output (" << (outOfCore ? "INTFILE.bin" : "INTFILE")
+                  << ", SYMTAB.txt) saved." << std::endl;
+    }
+
+    // 중간파일 모드: Pass1이 쓴 (또는 이전 실행의) 바이너리 중간파일을 mmap
+    IntermediateReader reader;
+    if (outOfCore) {
+        if (!reader.open(intRecords, intStrings, optab)) {
+            return 1;
+        }
+        reader.bindSymbols(symtab);
     }
-    
-    // Pass 1 결과 (중간파일) 저장
-    pass1.writeIntFile("output/INTFILE");
-    // SYMTAB 파일 저장
-    symtab.writeToFile("output/SYMTAB.txt");
-    std::cout << "Pass 1 output (INTFILE, SYMTAB.txt) saved." << std::endl;
 
     // 프로그램 정보
-    int startAddress = pass1.getStartAddress();
-    int programLength = pass1.getProgramLength();
-    std::string programName = pass1.getProgramName();
-    
+    int startAddress = outOfCore ? reader.getStartAddress() : pass1.getStartAddress();
+    int programLength = outOfCore ? reader.getProgramLength() : pass1.getProgramLength();
+    std::string programName = outOfCore ? reader.getProgramName() : pass1.getProgramName();
+
     // ==================================================
     // 4. [신규] Pass 2 실행
     // ==================================================
-    Pass2 pass2(&optab, &symtab, pass1.getIntFile(), 
-                startAddress, programLength, programName);
+    profiler.begin("Pass2");
+    std::unique_ptr<Pass2> pass2;
+    if (outOfCore) {
+        pass2.reset(new Pass2(&optab, &symtab, reader));
+    } else {
+        pass2.reset(new Pass2(&optab, &symtab, pass1.getIntFile(),
+                              startAddress, programLength, programName));
+    }
+    pass2->setTextRecordOptions(opts.trecOptions);
+    pass2->setEmitImage(opts.image);
+    LineMap lineMap;
+    if (opts.lineMapOut) {
+        lineMap.setSourceFile(srcFilename);
+        pass2->setLineMap(&lineMap);
+    }
 
-    if (!pass2.execute()) {
+    std::string objPath = outputs.path("output/OBJFILE");
+    bool pass2Ok = outOfCore ? pass2->executeOutOfCore(reader, objPath)
+                             : pass2->execute();
+    flushDiagnostics();
+    if (!pass2Ok) {
         std::cerr << "Pass 2 failed. Exiting..." << std::endl;
+        if (writer) writer->finish();
         return 1;
     }
 
-    // Pass 2 결과 (오브젝트 파일) 저장
-    pass2.writeObjFile("output/OBJFILE");
-    
+    // Pass 2 결과 (오브젝트 파일) 저장 (중간파일 모드는 실행 중에 이미 씀)
+    profiler.begin("output");
+    if (!outOfCore) {
+        output([&pass2, objPath]() { pass2->writeObjFile(objPath); });
+    }
+    if (opts.image) {
+        std::string imgPath = outputs.path("output/IMGFILE");
+        std::string hdrPath = outputs.path("output/IMGFILE.hdr");
+        output([&pass2, imgPath, hdrPath]() { pass2->writeImageFile(imgPath, hdrPath); });
+    }
+    if (opts.lineMapOut) {
+        std::string path = outputs.path("output/LINEMAP.bin");
+        output([&lineMap, path]() { lineMap.writeToFile(path); });
+    }
+
     // ==================================================
     // 5. [신규] 최종 결과 출력
     // ==================================================
     std::cout << "\n" << std::string(70, '=') << std::endl;
     std::cout << "     ASSEMBLY COMPLETED SUCCESSFULLY" << std::endl;
     std::cout << std::string(70, '=') << std::endl;
-    
-    // 최종 리스팅 파일 (objcode 포함)
-    pass2.printListingFile();
 
-    // 최종 오브젝트 파일
-    pass2.printObjFile();
+    // 최종 리스팅 파일 (objcode 포함), 최종 오브젝트 파일
+    // (중간파일 모드는 라인과 레코드를 메모리에 두지 않으므로 요약만 출력)
+    // 캐시를 쓰면 적중 시 다시 보여 줄 수 있도록 문자열로 받아 둠
+    std::ostringstream captured;
+    bool capture = cache != nullptr && !outOfCore;
+    if (!outOfCore && (!opts.quiet || capture)) {
+        std::ostream& listing = capture ? static_cast<std::ostream&>(captured) : std::cout;
+        pass2->printListingFile(listing);
+        pass2->printObjFile(listing);
+        if (capture && !opts.quiet) {
+            std::cout << captured.str();
+        }
+    }
+    pass2->printTextRecordSummary();
+
+    // 백그라운드 파일 출력 완료 대기
+    if (writer) {
+        writer->finish();
+    }
+
+    // ==================================================
+    // 6. [선택] 재배치 적재
+    // ==================================================
+    if (opts.loadAddr >= 0 && !loadProgram(objPath, opts.loadAddr, profiler)) {
+        return 1;
+    }
+    // 경고가 있으면 저장하지 않음 (적중 시 진단을 다시 보여 줄 수 없으므로)
+    if (cache != nullptr && !key.empty() && Diagnostics::warningCount() == 0) {
+        profiler.begin("cache");
+        std::vector<std::string> produced = outputs.files();
+        outputs.commit();
+        cache->store(key, produced, captured.str());
+    } else {
+        outputs.commit();
+    }
+    profiler.end();
 
     std::cout << "\n✓ All output files generated successfully!" << std::endl;
-    std::cout << "  - output/INTFILE (Pass 1 output)" << std::endl;
+    if (outOfCore) {
+        std::cout << "  - output/INTFILE.bin, output/INTFILE.str (Pass 1 output, binary)" << std::endl;
+        std::cout << "  - output/SYMTAB.bin (Symbol snapshot)" << std::endl;
+    } else {
+        std::cout << "  - output/INTFILE (Pass 1 output)" << std::endl;
+    }
     std::cout << "  - output/SYMTAB.txt (Symbol table)" << std::endl;
     std::cout << "  - output/OBJFILE (Pass 2 output)" << std::endl;
-    
+    if (opts.image) {
+        std::cout << "  - output/IMGFILE, output/IMGFILE.hdr (Memory image)" << std::endl;
+    }
+    if (opts.lineMapOut) {
+        std::cout << "  - output/LINEMAP.bin (Address to source line map)" << std::endl;
+    }
+    if (opts.diagJson) {
+        std::cout << "  - output/DIAGNOSTICS.json (Diagnostics)" << std::endl;
+    }
+
+    if (opts.profile) {
+        profiler.report();
+    }
     return 0;
-}
\ No newline at end of file
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    // ==================================================
+    // 0. 옵션 처리
+    // ==================================================
+    AssembleOptions opts;
+    std::string disasmFile;  // --disasm <objfile>: 조립 대신 역어셈블
+    std::string symtabFile;  // --symtab <file>: 역어셈블 시 심볼 이름 표시
+    std::vector<int> addr2line;  // --addr2line <hex>: LINEMAP.bin으로 주소의 소스 라인 조회 (반복 가능)
+    bool watch = false;      // --watch: 소스/OPTAB이 바뀔 때마다 다시 조립 (OPTAB은 메모리에 유지)
+    int debounceMillis = 200;  // --debounce <ms>: 마지막 저장 후 이만큼 조용하면 조립
+    for (int k = 1; k < argc; ++k) {
+        std::string arg = argv[k];
+        if (arg == "--load" && k + 1 < argc) {
+            if (!Parser::parseNumber(argv[++k], opts.loadAddr, 16)) {
+                std::cerr << "Invalid load address: " << argv[k] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--disasm" && k + 1 < argc) {
+            disasmFile = argv[++k];
+        } else if (arg == "--symtab" && k + 1 < argc) {
+            symtabFile = argv[++k];
+        } else if (arg == "--pack-res") {
+            opts.packRes = true;
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg == "--pipeline") {
+            opts.pipeline = true;
+        } else if (arg == "--symtab-bin") {
+            opts.symtabBin = true;
+        } else if (arg == "--import-symbols" && k + 1 < argc) {
+            opts.importSymbols = argv[++k];
+        } else if (arg == "--preload-symbols" && k + 1 < argc) {
+            opts.preloadSymbols = argv[++k];
+        } else if ((arg == "--trec-max" || arg == "--trec-gap") && k + 1 < argc) {
+            int value = 0;
+            bool isMax = (arg == "--trec-max");
+            if (!Parser::parseNumber(argv[++k], value) ||
+                (isMax ? (value < 1 || value > 255) : (value < 0 || value > 255))) {
+                std::cerr << "Invalid value for " << arg << ": " << argv[k]
+                          << (isMax ? " (1..255)" : " (0..255)") << std::endl;
+                return 1;
+            }
+            if (isMax) opts.trecOptions.maxLength = value;
+            else opts.trecOptions.gapFill = value;
+        } else if (arg == "--out-of-core") {
+            opts.outOfCore = true;
+        } else if (arg == "--pass2-only") {
+            opts.pass2Only = true;
+        } else if (arg == "--line-map") {
+            opts.lineMapOut = true;
+        } else if (arg == "--addr2line" && k + 1 < argc) {
+            int addr = 0;
+            if (!Parser::parseNumber(argv[++k], addr, 16)) {
+                std::cerr << "Invalid address: " << argv[k] << std::endl;
+                return 1;
+            }
+            addr2line.push_back(addr);
+        } else if (arg == "--optimize") {
+            opts.optimize = true;
+        } else if (arg == "--strip") {
+            opts.strip = true;
+        } else if (arg == "--image") {
+            opts.image = true;
+        } else if (arg == "--max-errors" && k + 1 < argc) {
+            if (!Parser::parseNumber(argv[++k], opts.maxErrors) || opts.maxErrors < 0) {
+                std::cerr << "Invalid value for --max-errors: " << argv[k] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--diag-json") {
+            opts.diagJson = true;
+        } else if (arg == "--check") {
+            opts.check = true;
+        } else if (arg == "--watch") {
+            watch = true;
+        } else if (arg == "--debounce" && k + 1 < argc) {
+            if (!Parser::parseNumber(argv[++k], debounceMillis) || debounceMillis < 0) {
+                std::cerr << "Invalid value for --debounce: " << argv[k] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--cache" && k + 1 < argc) {
+            opts.cacheDir = argv[++k];
+        } else if (arg == "--cache-max" && k + 1 < argc) {
+            int megabytes = 0;
+            if (!Parser::parseNumber(argv[++k], megabytes) || megabytes < 1) {
+                std::cerr << "Invalid value for --cache-max: " << argv[k] << std::endl;
+                return 1;
+            }
+            opts.cacheMaxBytes = static_cast<uint64_t>(megabytes) << 20;
+        } else if (arg == "--trec-split") {
+            opts.trecOptions.splitData = true;
+        } else if (arg == "--trec-fill") {
+            opts.trecOptions.fillRecords = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::cerr << "Usage: " << argv[0] << " [--load <hex address>] [--pack-res] [--profile] [--pipeline]"
+                      << " [--symtab-bin] [--import-symbols <file>] [--preload-symbols <file>]"
+                      << " [--trec-max <n>] [--trec-split] [--trec-gap <n>] [--trec-fill] [--image]"
+                      << " [--out-of-core | --pass2-only] [--optimize] [--strip] [--line-map]"
+                      << " [--max-errors <n>] [--diag-json] [--watch [--debounce <ms>]]"
+                      << " [--cache <dir> [--cache-max <MB>]]" << std::endl;
+            std::cerr << "       " << argv[0] << " --check [--max-errors <n>] [--diag-json] [--watch]" << std::endl;
+            std::cerr << "       " << argv[0] << " --disasm <objfile> [--symtab <file>]" << std::endl;
+            std::cerr << "       " << argv[0] << " --addr2line <hex address> ..." << std::endl;
+            return 1;
+        }
+    }
+
+    // 최적화/제거는 메모리에 있는 중간파일을 고쳐 쓰므로 중간파일 모드와 함께 쓸 수 없음
+    if ((opts.optimize || opts.strip) && (opts.outOfCore || opts.pass2Only)) {
+        std::cerr << (opts.optimize ? "--optimize" : "--strip")
+                  << " cannot be combined with --out-of-core or --pass2-only" << std::endl;
+        return 1;
+    }
+    // --check는 소스부터 검사하므로 이전 실행의 중간파일만 읽는 모드와 함께 쓸 수 없음
+    if (opts.check && opts.pass2Only) {
+        std::cerr << "--check cannot be combined with --pass2-only" << std::endl;
+        return 1;
+    }
+    // --pass2-only는 소스를 읽지 않으므로 감시할 것이 없음
+    if (watch && opts.pass2Only) {
+        std::cerr << "--watch cannot be combined with --pass2-only" << std::endl;
+        return 1;
+    }
+
+    // 캐시 키는 소스에서 시작하는 조립만 다룸 (검사 모드는 출력이 없음)
+    if (!opts.cacheDir.empty() && (opts.check || opts.pass2Only)) {
+        std::cerr << "--cache cannot be combined with --check or --pass2-only" << std::endl;
+        return 1;
+    }
+
+    // 다른 프로세스에서 Pass2만 실행: 심볼은 이전 실행의 스냅샷에서 미리 채움
+    if (opts.pass2Only) {
+        opts.outOfCore = true;
+        if (opts.preloadSymbols.empty()) {
+            opts.preloadSymbols = "output/SYMTAB.bin";
+        }
+    }
+
+    // 주소 -> 소스 라인 조회 모드: 이전 --line-map 실행의 표만 읽고 종료
+    if (!addr2line.empty()) {
+        LineMap lineMap;
+        if (!lineMap.loadFromFile("output/LINEMAP.bin")) {
+            return 1;
+        }
+        for (int addr : addr2line) {
+            int line = lineMap.lookup(addr);
+            std::cout << std::hex << std::uppercase << std::setw(6) << std::setfill('0') << std::right
+                      << addr << std::dec << std::setfill(' ') << std::left << "  ";
+            if (line > 0) std::cout << lineMap.getSourceFile() << ":" << line << std::endl;
+            else std::cout << "??" << std::endl;
+        }
+        return 0;
+    }
+
+    // 검사 모드는 편집기 저장 훅에서 자주 부르므로 진행 메시지를 생략
+    if (!opts.check) {
+        std::cout << "\n" << std::string(70, '=') << std::endl;
+        std::cout << "           SIC/XE ASSEMBLER" << std::endl;
+        std::cout << std::string(70, '=') << std::endl;
+    }
+
+    // ==================================================
+    // 1. OPTAB 로드
+    // ==================================================
+    const std::string srcFilename = "input/SRCFILE";
+    const std::string optabFilename = "input/optab.txt";
+    if (!opts.check) {
+        std::cout << "\n[Step 1] Loading OPTAB..." << std::endl;
+    }
+    Profiler profiler;
+    profiler.begin("OPTAB load");
+    OPTAB optab;
+    if (!optab.load(optabFilename)) {
+        std::cerr << "Failed to load OPTAB. Exiting..." << std::endl;
+        return 1;
+    }
+
+    // 역어셈블 모드: OBJFILE만 읽고 종료
+    if (!disasmFile.empty()) {
+        std::cout << "\n[Disassembler] " << disasmFile << std::endl;
+        Disassembler disasm(&optab);
+        if (!symtabFile.empty() && !disasm.loadSymbols(symtabFile)) {
+            return 1;
+        }
+        return disasm.disassemble(disasmFile, std::cout) ? 0 : 1;
+    }
+
+    std::unique_ptr<AssemblyCache> cache;
+    if (!opts.cacheDir.empty()) {
+        cache.reset(new AssemblyCache(opts.cacheDir, opts.cacheMaxBytes));
+        if (!cache->open()) {
+            return 1;
+        }
+    }
+
+    auto run = [&optab, &srcFilename, &opts, &cache](Profiler& runProfiler) {
+        return opts.check ? checkFile(optab, srcFilename, opts)
+                          : assembleFile(optab, srcFilename, opts, runProfiler, cache.get());
+    };
+
+    int status = 0;
+    if (!watch) {
+        status = run(profiler);
+    } else {
+        // ==================================================
+        // 감시 모드: OPTAB은 바뀔 때만 다시 읽고, 소스는 내용이 바뀔 때만 다시 조립
+        // ==================================================
+        opts.quiet = true;
+        opts.keepUnchanged = true;
+        FileWatcher watcher;
+        if (!watcher.add(srcFilename) || !watcher.add(optabFilename)) {
+            return 1;
+        }
+        run(profiler);
+        auto lastSource = fingerprint(srcFilename);
+        auto lastOptab = fingerprint(optabFilename);
+
+        while (true) {
+            std::cout << "\n[Watch] Waiting for changes to " << srcFilename << " or "
+                      << optabFilename << " (Ctrl+C to stop)..." << std::endl;
+            std::vector<std::string> changed = watcher.wait(debounceMillis);
+            if (changed.empty()) break;  // inotify 오류
+
+            auto start = std::chrono::steady_clock::now();
+            auto optabNow = fingerprint(optabFilename);
+            bool optabChanged = optabNow != lastOptab;
+            if (optabChanged) {
+                OPTAB reloaded;
+                if (!reloaded.load(optabFilename)) {
+                    std::cerr << "Failed to reload OPTAB, keeping the previous one" << std::endl;
+                } else {
+                    optab = reloaded;
+                    lastOptab = optabNow;
+                }
+            }
+            auto sourceNow = fingerprint(srcFilename);
+            if (!optabChanged && sourceNow == lastSource) {
+                std::cout << "[Watch] Contents unchanged, skipping" << std::endl;
+                continue;
+            }
+            lastSource = sourceNow;
+
+            Profiler runProfiler;
+            status = run(runProfiler);
+            double millis = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start).count();
+            if (cache) {
+                cache->finish();
+            }
+            std::cout << "[Watch] Reassembled in " << std::fixed << std::setprecision(1) << millis
+                      << std::defaultfloat << " ms (" << (status == 0 ? "ok" : "failed") << ")"
+                      << std::endl;
+        }
+    }
+
+    if (cache) {
+        cache->finish();
+        cache->printStats();
+    }
+
+#ifdef ASM_TRACE
+    Trace::writeJson("output/TRACE.json");
+#endif
+
+    return status;
+}